@@ -0,0 +1,449 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    UARTブートローダー(ブートブロック 0x000〜0x1FF)
+
+    アプリケーション(リポジトリのトップ)とは別のプロジェクトとしてビルドし、MPLAB Snapで一度だけ書き込む。
+        xc8-cc -mcpu=16F18424 -O2 -mrom=0-1FF -o bootloader.hex bootloader.c
+    -mrom=0-1FF により、ブートブロックに収まらない場合はリンクでエラーになる。
+    アプリケーションはリンカーオプションに -mcodeoffset=0x200 を追加してビルドし(.vscode/pc-remocon.mplab.jsonで指定済み)、
+    以降は tools/bootload でUARTから書き込む。
+
+    起動時:
+        RESET命令以外のリセットで、アプリケーションの先頭(0x200)が書き込まれていれば、何も初期化せずにアプリケーションへ飛ぶ
+        アプリケーションがUARTのBOOTでRESET命令を実行した場合と、アプリケーションが無い場合はUARTの要求を待つ
+    書き込み:
+        最初のWRITEでアプリケーションの先頭行をRAMに移して消去し、FINISHで全体のCRCが一致するまで書き戻さない。
+        途中で通信や電源が切れても、次の起動ではブートローダーに留まるのでやり直せる
+        PIC16のフラッシュの消去・書き込み中はCPUが止まり、EUSARTの受信FIFOは2バイトしかないので、
+        受信と書き込みは重ねられない。1行ごとに書き込んでから応答し(ホストは応答を待って次の行を送る)、
+        ホストがROW_CRCで比較して内容の変わった行だけを送ることで時間を短くする
+*/
+
+#include <xc.h>
+#include <pic16f18424.h>
+#include "bootloader.h"
+
+#define _XTAL_FREQ          32000000    // RSTOSC=HFINT32
+#define BOOT_BAUD           115200
+#define BOOT_BRG            ((unsigned int)(_XTAL_FREQ / (4.0 * BOOT_BAUD) - 0.5))  // BRGH=1, BRG16=1
+#define BOOT_ERASED         0x3FFF
+
+#define BOOT_STR_(X)        #X
+#define BOOT_STR(X)         BOOT_STR_(X)
+
+// コンフィギュレーションはアプリケーション(main.c)と同じ値にすること
+//CONFIG1
+#pragma config FCMEN = ON
+#pragma config CSWEN = ON
+#pragma config CLKOUTEN = OFF
+#pragma config RSTOSC = HFINT32 // HFINTOSC with OSCFRQ=32MHz and CDIV=1:1
+#pragma config FEXTOSC = OFF
+
+//CONFIG2
+#pragma config MCLRE = ON
+#pragma config PWRTS = OFF
+#pragma config LPBOREN = OFF
+#pragma config BOREN = ON
+#pragma config BORV = LO
+#pragma config ZCD = OFF
+#pragma config PPS1WAY = ON
+#pragma config STVREN = ON
+
+//CONFIG3
+#pragma config WDTCPS = WDTCPS_31
+#pragma config WDTE = OFF
+#pragma config WDTCWS = WDTCWS_7
+#pragma config WDTCCS = SC
+
+//CONFIG4
+#pragma config BBSIZE = BB512
+#pragma config BBEN = ON        // 0x000〜0x1FFをブートブロックにする
+#pragma config SAFEN = OFF
+#pragma config WRTAPP = OFF
+#pragma config WRTB = ON        // ブートブロックは書き込み禁止
+#pragma config WRTC = OFF
+#pragma config WRTD = OFF
+#pragma config WRTSAF = OFF
+#pragma config LVP = ON
+
+//CONFIG5
+#pragma config CP = OFF
+
+typedef struct {
+    unsigned char   cmd;
+    unsigned char   len;
+    unsigned char   data[BOOT_PAYLOAD_MAX];
+} boot_frame_t;
+
+static boot_frame_t boot_frame;                         // 受信したフレーム(応答にも使う)
+static unsigned char boot_first[BOOT_ROW_SIZE * 2];     // アプリケーションの先頭行(FINISHで書き戻す)
+static unsigned char boot_first_pending;
+
+// ブートローダーは割り込みを使わないので、アプリケーションの割り込みベクターへ飛ぶだけ
+void __interrupt() boot_isr(void)
+{
+    asm("PAGESEL " BOOT_STR(BOOT_APP_VECTOR));
+    asm("GOTO " BOOT_STR(BOOT_APP_VECTOR));
+}
+
+static void boot_start_app(void)
+{
+    asm("PAGESEL " BOOT_STR(BOOT_APP_START));
+    asm("GOTO " BOOT_STR(BOOT_APP_START));
+}
+
+//--------------------------------------------------------------------------------
+// フラッシュ
+
+static void boot_unlock(void)
+{
+    NVMCON2 = 0x55;
+    NVMCON2 = 0xAA;
+    NVMCON1bits.WR = 1; // 消去・書き込み中はCPUが停止する
+    while( NVMCON1bits.WR != 0 );
+}
+
+static void boot_set_addr(unsigned int addr)
+{
+    NVMADRL = addr & 0xFF;
+    NVMADRH = addr >> 8;
+}
+
+static unsigned int boot_read(unsigned int addr)
+{
+    boot_set_addr(addr);
+    NVMCON1bits.RD = 1;
+    return ((unsigned int)NVMDATH << 8) | NVMDATL;
+}
+
+static void boot_erase(unsigned int addr)
+{
+    boot_set_addr(addr);
+    NVMCON1bits.FREE = 1;
+    NVMCON1bits.WREN = 1;
+    boot_unlock();
+    NVMCON1bits.FREE = 0;
+    NVMCON1bits.WREN = 0;
+}
+
+// 消去済みの行に1行分(下位・上位の順のバイト列)を書き込む
+static void boot_write(unsigned int addr, const unsigned char *data)
+{
+    unsigned char i;
+
+    NVMCON1bits.WREN = 1;
+    NVMCON1bits.LWLO = 1;
+    for( i = 0; i < BOOT_ROW_SIZE; i++, addr++, data += 2 )
+    {
+        boot_set_addr(addr);
+        NVMDATL = data[0];
+        NVMDATH = data[1];
+        if( i == BOOT_ROW_SIZE - 1 )
+            NVMCON1bits.LWLO = 0;   // 最後のワードで書き込みを実行する
+        boot_unlock();
+    }
+    NVMCON1bits.WREN = 0;
+}
+
+// 書き戻す前の先頭行はRAMの内容を使う
+static unsigned int boot_word(unsigned int addr)
+{
+    unsigned char pos;
+
+    if( boot_first_pending != 0 && addr < BOOT_APP_START + BOOT_ROW_SIZE )
+    {
+        pos = (unsigned char)(addr - BOOT_APP_START) * 2;
+        return ((unsigned int)boot_first[pos + 1] << 8) | boot_first[pos];
+    }
+    return boot_read(addr);
+}
+
+// 1行が一致すれば0
+static unsigned char boot_compare(unsigned int addr, const unsigned char *data)
+{
+    unsigned char i;
+    unsigned int word;
+
+    for( i = 0; i < BOOT_ROW_SIZE; i++, addr++, data += 2 )
+    {
+        word = boot_word(addr);
+        if( (word & 0xFF) != data[0] || (word >> 8) != (data[1] & 0x3F) )
+            return 1;
+    }
+    return 0;
+}
+
+static unsigned int boot_crc16(unsigned int crc, unsigned int addr, unsigned int count)
+{
+    unsigned int word;
+    unsigned char i, n;
+
+    for( ; count > 0; count--, addr++ )
+    {
+        word = boot_word(addr);
+        for( n = 0; n < 2; n++, word >>= 8 )
+        {
+            crc ^= (word & 0xFF) << 8;
+            for( i = 0; i < 8; i++ )
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static boot_result_t boot_program(unsigned int addr, const unsigned char *data)
+{
+    unsigned char i;
+    unsigned int word;
+
+    // 最初の書き込みで先頭行を消去して、書き終わるまでアプリケーションを起動しないようにする
+    if( boot_first_pending == 0 )
+    {
+        for( i = 0; i < BOOT_ROW_SIZE; i++ )
+        {
+            word = boot_read(BOOT_APP_START + i);
+            boot_first[i * 2] = word & 0xFF;
+            boot_first[i * 2 + 1] = word >> 8;
+        }
+        boot_erase(BOOT_APP_START);
+        boot_first_pending = 1;
+    }
+
+    if( boot_compare(addr, data) == 0 )
+        return BOOT_RESULT_UNCHANGED;
+    if( addr == BOOT_APP_START )
+    {
+        for( i = 0; i < BOOT_ROW_SIZE * 2; i++ )
+            boot_first[i] = data[i];
+        return BOOT_RESULT_OK;
+    }
+    boot_erase(addr);
+    boot_write(addr, data);
+    return boot_compare(addr, data) == 0 ? BOOT_RESULT_OK : BOOT_RESULT_VERIFY;
+}
+
+static boot_result_t boot_finish(void)
+{
+    if( boot_first_pending == 0 )
+        return BOOT_RESULT_OK;
+    boot_write(BOOT_APP_START, boot_first);
+    boot_first_pending = 0;
+    return boot_compare(BOOT_APP_START, boot_first) == 0 ? BOOT_RESULT_OK : BOOT_RESULT_VERIFY;
+}
+
+//--------------------------------------------------------------------------------
+// UART
+
+static unsigned char boot_crc8(unsigned char crc, unsigned char data)
+{
+    unsigned char i;
+
+    crc ^= data;
+    for( i = 0; i < 8; i++ )
+    {
+        crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+    return crc;
+}
+
+static unsigned char boot_getc(void)
+{
+    while( PIR3bits.RC1IF == 0 )
+    {
+        if( RC1STAbits.OERR )
+        {
+            // オーバーランの解除
+            RC1STAbits.CREN = 0;
+            RC1STAbits.CREN = 1;
+        }
+    }
+    return RC1REG;
+}
+
+static void boot_putc(unsigned char data)
+{
+    while( PIR3bits.TX1IF == 0 );
+    TX1REG = data;
+}
+
+// CRCの一致するフレームを受信するまで待つ(一致しないフレームには応答しない)
+static void boot_receive(void)
+{
+    unsigned char crc;
+    unsigned char pos;
+
+    while( 1 )
+    {
+        if( boot_getc() != BOOT_SOF )
+            continue;
+        boot_frame.cmd = boot_getc();
+        boot_frame.len = boot_getc();
+        if( boot_frame.len > BOOT_PAYLOAD_MAX )
+            continue;
+        crc = boot_crc8(boot_crc8(0, boot_frame.cmd), boot_frame.len);
+        for( pos = 0; pos < boot_frame.len; pos++ )
+        {
+            boot_frame.data[pos] = boot_getc();
+            crc = boot_crc8(crc, boot_frame.data[pos]);
+        }
+        if( boot_getc() == crc )
+            return;
+    }
+}
+
+static void boot_send(unsigned char cmd, unsigned char len)
+{
+    unsigned char crc;
+    unsigned char pos;
+
+    boot_putc(BOOT_SOF);
+    boot_putc(cmd);
+    boot_putc(len);
+    crc = boot_crc8(boot_crc8(0, cmd), len);
+    for( pos = 0; pos < len; pos++ )
+    {
+        boot_putc(boot_frame.data[pos]);
+        crc = boot_crc8(crc, boot_frame.data[pos]);
+    }
+    boot_putc(crc);
+}
+
+// 応答はboot_frame.dataに書いて返す
+static void boot_dispatch(void)
+{
+    unsigned char cmd = boot_frame.cmd;
+    unsigned char *data = boot_frame.data;
+    unsigned int addr = ((unsigned int)data[1] << 8) | data[0];
+    unsigned int crc;
+    unsigned char count;
+    unsigned char i;
+
+    switch( cmd )
+    {
+        case BOOT_CMD_INFO:
+            if( boot_frame.len != 0 )
+                break;
+            data[0] = BOOT_VERSION;
+            data[1] = BOOT_ROW_SIZE;
+            data[2] = BOOT_APP_START & 0xFF;
+            data[3] = BOOT_APP_START >> 8;
+            data[4] = BOOT_APP_END & 0xFF;
+            data[5] = BOOT_APP_END >> 8;
+            boot_send(cmd | BOOT_RESPONSE, 6);
+            return;
+
+        case BOOT_CMD_ROW_CRC:
+            count = data[2];
+            if( boot_frame.len != 3 || (addr & (BOOT_ROW_SIZE - 1)) != 0 || addr < BOOT_APP_START
+                || count == 0 || count > BOOT_CRC_ROWS_MAX
+                || addr + (unsigned int)count * BOOT_ROW_SIZE > BOOT_APP_END )
+                break;
+            for( i = 0; i < count; i++, addr += BOOT_ROW_SIZE )
+            {
+                crc = boot_crc16(BOOT_CRC_INIT, addr, BOOT_ROW_SIZE);
+                data[2 + i * 2] = crc & 0xFF;
+                data[3 + i * 2] = crc >> 8;
+            }
+            boot_send(cmd | BOOT_RESPONSE, 2 + count * 2);
+            return;
+
+        case BOOT_CMD_WRITE:
+            if( boot_frame.len != BOOT_PAYLOAD_MAX || (addr & (BOOT_ROW_SIZE - 1)) != 0
+                || addr < BOOT_APP_START || addr >= BOOT_APP_END )
+                break;
+            data[2] = boot_program(addr, &data[2]);
+            boot_send(cmd | BOOT_RESPONSE, 3);
+            return;
+
+        case BOOT_CMD_FINISH:
+            if( boot_frame.len != 2 )
+                break;
+            crc = ((unsigned int)data[1] << 8) | data[0];
+            if( boot_crc16(BOOT_CRC_INIT, BOOT_APP_START, BOOT_APP_END - BOOT_APP_START) != crc )
+            {
+                data[0] = BOOT_RESULT_CRC;
+                boot_send(cmd | BOOT_RESPONSE, 1);
+                return;
+            }
+            data[0] = boot_finish();
+            boot_send(cmd | BOOT_RESPONSE, 1);
+            if( data[0] != BOOT_RESULT_OK )
+                return;
+
+            // 送信の完了を待ち、アプリケーションが初期化しない設定を起動時の状態に戻す
+            while( TX1STAbits.TRMT == 0 );
+            RC1STA = 0x00;
+            TX1STA = 0x02;
+            BAUD1CON = 0x00;
+            RA4PPS = 0x00;
+            TRISAbits.TRISA4 = 1;
+            boot_start_app();
+            return;
+
+        default:
+            break;
+    }
+    data[0] = cmd;
+    data[1] = BOOT_RESULT_INVALID;
+    boot_send(BOOT_CMD_ERROR, 2);
+}
+
+static void boot_init(void)
+{
+    // RA4: UART TX (OUT)
+    ANSELAbits.ANSA4 = 0;
+    LATAbits.LATA4 = 1;
+    TRISAbits.TRISA4 = 0;
+    RA4PPS = 0x0F;      // TX1/CK1
+
+    // RC2: UART RX (IN)
+    ANSELCbits.ANSC2 = 0;
+    TRISCbits.TRISC2 = 1;
+    RX1DTPPS = 0x12;    // RC2
+
+    BAUD1CON = 0x08;    // ABDOVF=0, RCIDL=0, (0), SCKP=0, BRG16=1, (0), WUE=0, ABDEN=0
+    SP1BRGL = BOOT_BRG & 0xFF;
+    SP1BRGH = BOOT_BRG >> 8;
+    TX1STA = 0x24;      // CSRC=0, TX9=0, TXEN=1, SYNC=0, SENDB=0, BRGH=1, (TRMT), TX9D=0
+    RC1STA = 0x90;      // SPEN=1, RX9=0, SREN=0, CREN=1, ADDEN=0, (FERR), (OERR), RX9D=0
+
+    NVMCON1bits.NVMREGS = 0;
+}
+
+void main(void)
+{
+    // RESET命令(アプリケーションのBOOT要求)以外のリセットで、アプリケーションがあれば起動する
+    if( PCON0bits.nRI != 0 && boot_read(BOOT_APP_START) != BOOT_ERASED )
+        boot_start_app();
+    PCON0bits.nRI = 1;
+
+    boot_init();
+    while( 1 )
+    {
+        boot_receive();
+        boot_dispatch();
+    }
+}
@@ -0,0 +1,61 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_BOOTLOADER_H_
+#define _IR_REMOCON_ANALYZER_BOOTLOADER_H_
+
+// ブートブロック(0x000〜0x1FF, CONFIG4のBBSIZE=BB512)に置くUARTブートローダー
+// ホストツール(tools/bootload.c)からも読み込むので、PIC固有の定義は書かないこと
+
+#define BOOT_VERSION        1
+#define BOOT_ROW_SIZE       32          // 消去・書き込みの単位(ワード)
+#define BOOT_APP_START      0x0200      // アプリケーションのリセットベクター(XC8の-mcodeoffset=0x200)
+#define BOOT_APP_VECTOR     0x0204      // アプリケーションの割り込みベクター
+#define BOOT_APP_END        0x0F80      // HEF(設定・統計)の手前まで。HEFは書き換えない
+#define BOOT_CRC_ROWS_MAX   16          // ROW_CRCの応答1回で返す行数
+
+// フレームはアプリケーションのUARTと同じ: SOF(0xA5), CMD, LEN, DATA[LEN], CRC8(CMD〜DATA, 多項式0x07, 初期値0x00)
+// 応答のCMDは要求のCMD | 0x80。アドレスはワード単位、16bitの値はリトルエンディアン
+#define BOOT_SOF            0xA5
+#define BOOT_RESPONSE       0x80
+#define BOOT_PAYLOAD_MAX    (2 + BOOT_ROW_SIZE * 2)
+
+#define BOOT_CMD_INFO       0x41    // 応答: BOOT_VERSION, 行のサイズ, アプリケーションの開始・終了アドレス
+#define BOOT_CMD_ROW_CRC    0x42    // 要求: アドレス, 行数, 応答: アドレス, 各行のCRC16(最大BOOT_CRC_ROWS_MAX行)
+#define BOOT_CMD_WRITE      0x43    // 要求: アドレス, 1行分のデータ(各ワード16bit), 応答: アドレス, boot_result_t
+#define BOOT_CMD_FINISH     0x44    // 要求: アプリケーション全体のCRC16, 応答: boot_result_t(一致すればアプリケーションを起動)
+#define BOOT_CMD_ERROR      0x7F    // 応答: 要求のCMD, boot_result_t
+
+// CRC16: 多項式0x1021, 初期値0xFFFF。各ワードを下位・上位の順に計算する(未使用のワードは0x3FFF)
+#define BOOT_CRC_INIT       0xFFFF
+
+typedef enum {
+    BOOT_RESULT_OK = 0,             // 書き込んだ(FINISHはCRCが一致した)
+    BOOT_RESULT_UNCHANGED,          // 書き込み済みの内容と同じなので書き込まなかった
+    BOOT_RESULT_INVALID,            // アドレス・長さが不正
+    BOOT_RESULT_VERIFY,             // 書き込み後の読み出しが一致しない
+    BOOT_RESULT_CRC,                // FINISHのCRCが一致しない
+} boot_result_t;
+
+#endif // _IR_REMOCON_ANALYZER_BOOTLOADER_H_
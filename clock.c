@@ -0,0 +1,136 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "clock.h"
+#include "uart.h"
+
+clock_stats_t clock_stats;
+
+#ifdef CLOCK_SWITCH_ENABLE
+
+// SMT, TMR2/4/6, NCOはMFINTOSC、TMR0/1はLFINTOSCで動作するため、HFFRQを変えても影響を受けない
+// 影響を受けるのは命令の実行速度、__delay_ms、UARTのボーレートのみ
+typedef struct {
+    unsigned char   fast;       // 現在高速で動作中
+    unsigned char   active;     // 赤外線の受信中(clock_fast〜clock_idle)
+    unsigned char   hold;       // clock_hold()の入れ子の数
+} clock_data_t;
+
+clock_data_t clock_data;
+#define CLOCK   clock_data
+
+static void clock_set(unsigned char fast)
+{
+    uart_wait_idle();
+    OSCFRQ = fast ? CLOCK_FAST_HFFRQ : CLOCK_IDLE_HFFRQ;
+    while( OSCSTATbits.HFOR == 0 );
+    CLOCK.fast = fast;
+    uart_clock_changed(fast);
+}
+
+void clock_fast(void)
+{
+    unsigned int latency;
+
+    CLOCK.active = 1;
+    if( CLOCK.fast != 0 )
+        return;
+
+    clock_set(1);
+
+    // SMTは高/低時間測定モードでエッジごとにリセットされるので、経過時間がそのまま遅延になる
+    latency = SMT1TMRL;
+    latency |= (unsigned int)SMT1TMRH << 8;
+    clock_stats.switch_ups++;
+    clock_stats.latency_last = latency;
+    if( clock_stats.latency_max < latency )
+        clock_stats.latency_max = latency;
+}
+
+void clock_idle(void)
+{
+    CLOCK.active = 0;
+    if( CLOCK.hold == 0 && CLOCK.fast != 0 )
+        clock_set(0);
+}
+
+void clock_hold(void)
+{
+    CLOCK.hold++;
+    if( CLOCK.fast == 0 )
+        clock_set(1);
+}
+
+void clock_release(void)
+{
+    if( CLOCK.hold != 0 )
+        CLOCK.hold--;
+    if( CLOCK.hold == 0 && CLOCK.active == 0 && CLOCK.fast != 0 )
+        clock_set(0);
+}
+
+void clock_init(void)
+{
+    c_memzero(&CLOCK, sizeof(CLOCK));
+    c_memzero(&clock_stats, sizeof(clock_stats));
+    CLOCK.fast = 1;     // RSTOSC=HFINT32
+    clock_set(0);
+}
+
+#else
+
+void clock_fast(void)
+{
+}
+
+void clock_idle(void)
+{
+}
+
+void clock_hold(void)
+{
+}
+
+void clock_release(void)
+{
+}
+
+void clock_init(void)
+{
+    c_memzero(&clock_stats, sizeof(clock_stats));
+}
+
+#endif  // CLOCK_SWITCH_ENABLE
+
+void clock_wait(void)
+{
+#ifdef CLOCK_IDLE_ENABLE
+    // 割り込み禁止でも、割り込み要因(xxIF & xxIE)が立てばIDLEから復帰する。
+    // 復帰後にei()で割り込み処理が実行される(SLEEPの前に立っていた場合はSLEEPはNOPになる)
+    CPUDOZEbits.IDLEN = 1;  // SLEEP命令でSLEEPではなくIDLEに入る
+    SLEEP();
+    NOP();
+#endif
+}
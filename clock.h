@@ -0,0 +1,60 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_CLOCK_H_
+#define _IR_REMOCON_ANALYZER_CLOCK_H_
+
+#include "uart.h"
+
+#define CLOCK_SWITCH_ENABLE         // 待機中はシステムクロックを下げる
+#define CLOCK_IDLE_ENABLE           // 待機中はIDLEモードでCPUを止める(システムクロックと周辺は動作を続ける)
+
+// 高速時のクロック。__delay_ms等(_XTAL_FREQ)は高速時のみ正しいので、使う前にclock_hold()で保持すること
+#define CLOCK_FAST_HFFRQ    0x06    // 32MHz
+#ifdef UART_ENABLE
+// UARTの受信・応答を待機中も処理できる周波数(115200bpsの誤差+2.1%)
+#define CLOCK_IDLE_HFFRQ    0x03    // 8MHz
+#define CLOCK_IDLE_FREQ     8000000
+#else
+#define CLOCK_IDLE_HFFRQ    0x00    // 1MHz
+#define CLOCK_IDLE_FREQ     1000000
+#endif
+
+typedef struct {
+    unsigned int    switch_ups;     // 高速への切り替え回数
+    unsigned int    latency_last;   // エッジから高速に切り替わるまでの時間(SMTカウント, 2us単位)
+    unsigned int    latency_max;
+} clock_stats_t;
+
+extern clock_stats_t clock_stats;
+
+// いずれも割り込み禁止の状態(割り込み処理内を含む)で呼ぶこと
+void clock_fast(void);      // 赤外線の受信開始時
+void clock_idle(void);      // 受信の終了時(リピートのタイムアウト)
+void clock_hold(void);      // 高速のまま保持する(メインループの動作、送信中)
+void clock_release(void);
+void clock_wait(void);      // 割り込みが入るまでCPUを止める(メインループの待機中)
+void clock_init(void);
+
+#endif // _IR_REMOCON_ANALYZER_CLOCK_H_
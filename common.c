@@ -59,3 +59,12 @@ int c_memcmp(void *data1, void *data2, int length)
     }
     return 0;
 }
+
+// 時間を実行時に指定する場合の__delay_ms
+void c_delay_10ms(unsigned char count)
+{
+    for(;count>0;count--)
+    {
+        __delay_ms(10);
+    }
+}
@@ -38,5 +38,6 @@
 void c_memzero(void *data, int length);
 void c_memcopy(void *dest, const void *src, int length);
 int c_memcmp(void *data1, void *data2, int length);
+void c_delay_10ms(unsigned char count);
 
 #endif // _IR_REMOCON_ANALYZER_COMMON_H_
@@ -0,0 +1,64 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "debug_pin.h"
+
+#ifdef DEBUG_PIN_ENABLE
+
+unsigned char debug_pin_main;   // メインループの動作中(割り込みの終了時にHに戻す)
+
+void debug_pin_exit(debug_src_t src)
+{
+    unsigned char n;
+
+    if( src == DEBUG_SRC_MAIN )
+        debug_pin_main = 0;
+    for( n = src; n != 0; n-- )
+    {
+        DEBUG_PIN_LAT = 0;
+        DEBUG_PIN_LAT = 1;
+    }
+    DEBUG_PIN_LAT = debug_pin_main;
+}
+
+void debug_pin_init(void)
+{
+    debug_pin_main = 0;
+    DEBUG_PIN_ANSEL = 0;
+    DEBUG_PIN_LAT = 0;
+    DEBUG_PIN_TRIS = 0;
+}
+
+#else
+
+void debug_pin_exit(debug_src_t src)
+{
+}
+
+void debug_pin_init(void)
+{
+}
+
+#endif  // DEBUG_PIN_ENABLE
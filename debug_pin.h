@@ -0,0 +1,93 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_DEBUG_PIN_H_
+#define _IR_REMOCON_ANALYZER_DEBUG_PIN_H_
+
+#include "ir_transmitter.h"
+#include "uart.h"
+
+//#define DEBUG_PIN_ENABLE          // 割り込み処理とメインループの動作中にデバッグピンをHにする(ロジックアナライザ用)
+#ifndef DEBUG_PIN_RC
+#define DEBUG_PIN_RC        4       // デバッグピン(RCxの番号)。赤外線送信と併用する場合はUARTを無効にしてRC2を指定する
+#endif
+
+// 処理の終了時に、Hのまま番号の数だけ短いLパルスを出してからLに戻す
+// (メインループの動作中に割り込みが入った場合は、Lパルスの後Hに戻る)
+typedef enum {
+    DEBUG_SRC_NONE = 0,
+    DEBUG_SRC_PWA,          // ir_receiver_pwa_isr
+    DEBUG_SRC_PRA,          // ir_receiver_pra_isr
+    DEBUG_SRC_FRAME,        // ir_receiver_isr
+    DEBUG_SRC_TIMEOUT,      // ir_receiver_tmr_isr
+    DEBUG_SRC_MAIN,         // メインループの動作
+    DEBUG_SRC_TIMER,        // power_timer_isr, power_timer_cal_isr
+    DEBUG_SRC_LED,          // power_stats_ioc_isr
+    DEBUG_SRC_MAX
+} debug_src_t;
+
+#ifdef DEBUG_PIN_ENABLE
+
+#ifndef DEBUG_PIN_SIM  // シミュレーターはピンを使わない
+#if DEBUG_PIN_RC == 4 && defined(IRT_ENABLE)
+#error "RC4は赤外線送信で使用しています。DEBUG_PIN_RCを変更してください"
+#endif
+#if DEBUG_PIN_RC == 2 && defined(UART_ENABLE)
+#error "RC2はUARTの受信で使用しています。UART_ENABLEを無効にするか、DEBUG_PIN_RCを変更してください"
+#endif
+#if DEBUG_PIN_RC == 0 || DEBUG_PIN_RC == 1 || DEBUG_PIN_RC == 3 || DEBUG_PIN_RC == 5
+#error "DEBUG_PIN_RCのピンは使用中です"  // RC0: 電源LED, RC1/RC5: 赤外線受信, RC3: LED
+#endif
+#endif
+
+#define DEBUG_PIN_PASTE_(A, B)  A##B
+#define DEBUG_PIN_PASTE(A, B)   DEBUG_PIN_PASTE_(A, B)
+#define DEBUG_PIN_LAT           DEBUG_PIN_PASTE(LATCbits.LATC, DEBUG_PIN_RC)
+#define DEBUG_PIN_TRIS          DEBUG_PIN_PASTE(TRISCbits.TRISC, DEBUG_PIN_RC)
+#define DEBUG_PIN_ANSEL         DEBUG_PIN_PASTE(ANSELCbits.ANSC, DEBUG_PIN_RC)
+
+extern unsigned char debug_pin_main;
+
+#ifdef DEBUG_PIN_SIM
+// ホストシミュレーター(tools/sim)で時間とピンの変化を記録する
+void sim_debug_enter(debug_src_t src);
+void sim_debug_exit(debug_src_t src);
+#define DEBUG_ENTER(SRC)    sim_debug_enter(SRC)
+#define DEBUG_EXIT(SRC)     sim_debug_exit(SRC)
+#else
+#define DEBUG_ENTER(SRC)    do { if( (SRC) == DEBUG_SRC_MAIN ) debug_pin_main = 1; DEBUG_PIN_LAT = 1; } while(0)
+#define DEBUG_EXIT(SRC)     debug_pin_exit(SRC)
+#endif
+
+#else
+
+#define DEBUG_ENTER(SRC)
+#define DEBUG_EXIT(SRC)
+
+#endif  // DEBUG_PIN_ENABLE
+
+void debug_pin_exit(debug_src_t src);
+void debug_pin_init(void);
+
+#endif // _IR_REMOCON_ANALYZER_DEBUG_PIN_H_
@@ -0,0 +1,99 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "hef.h"
+
+static void hef_unlock(void)
+{
+    char gie = INTCONbits.GIE;
+
+    di();
+    NVMCON2 = 0x55;
+    NVMCON2 = 0xAA;
+    NVMCON1bits.WR = 1; // 消去・書き込み中はCPUが停止する
+    while( NVMCON1bits.WR != 0 );
+    if( gie )
+        ei();
+}
+
+unsigned int hef_read(unsigned int addr)
+{
+    NVMCON1bits.NVMREGS = 0;
+    NVMADRL = addr & 0xFF;
+    NVMADRH = addr >> 8;
+    NVMCON1bits.RD = 1;
+    return ((unsigned int)NVMDATH << 8) | NVMDATL;
+}
+
+void hef_erase_row(unsigned int addr)
+{
+    NVMCON1bits.NVMREGS = 0;
+    NVMADRL = addr & 0xFF;
+    NVMADRH = addr >> 8;
+    NVMCON1bits.FREE = 1;
+    NVMCON1bits.WREN = 1;
+    hef_unlock();
+    NVMCON1bits.FREE = 0;
+    NVMCON1bits.WREN = 0;
+}
+
+// 同じ行の中で連続したワードを書き込む
+// 書き込まないラッチは0x3FFFのままなので、消去済みのワードへの追記にも使える
+void hef_write(unsigned int addr, const unsigned int *data, unsigned char count)
+{
+    NVMCON1bits.NVMREGS = 0;
+    NVMCON1bits.WREN = 1;
+    NVMCON1bits.LWLO = 1;
+    for( ; count > 0; count--, addr++, data++ )
+    {
+        NVMADRL = addr & 0xFF;
+        NVMADRH = addr >> 8;
+        NVMDATL = *data & 0xFF;
+        NVMDATH = *data >> 8;
+        if( count == 1 )
+            NVMCON1bits.LWLO = 0;   // 最後のワードで書き込みを実行する
+        hef_unlock();
+    }
+    NVMCON1bits.WREN = 0;
+}
+
+// 1バイトを1ワードの下位8bit(高耐久の部分)に書き込む。上位は0になる
+void hef_write_bytes(unsigned int addr, const unsigned char *data, unsigned char count)
+{
+    NVMCON1bits.NVMREGS = 0;
+    NVMCON1bits.WREN = 1;
+    NVMCON1bits.LWLO = 1;
+    for( ; count > 0; count--, addr++, data++ )
+    {
+        NVMADRL = addr & 0xFF;
+        NVMADRH = addr >> 8;
+        NVMDATL = *data;
+        NVMDATH = 0x00;
+        if( count == 1 )
+            NVMCON1bits.LWLO = 0;   // 最後のワードで書き込みを実行する
+        hef_unlock();
+    }
+    NVMCON1bits.WREN = 0;
+}
@@ -0,0 +1,42 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_HEF_H_
+#define _IR_REMOCON_ANALYZER_HEF_H_
+
+// High-Endurance Flash (プログラムメモリの最後の128ワード)
+// 下位8bitのみ高耐久。リンカーオプションで -mreserve=rom@0xF80:0xFFF を指定してコードを配置しないこと
+#define HEF_ADDR            0x0F80
+#define HEF_ROW_SIZE        32          // 消去単位(ワード)
+#define HEF_ROWS            4
+#define HEF_SETTINGS_ROWS   3           // 先頭から3行: 設定のログ(settings.c)
+#define HEF_STATS_ROW       3           // 最後の1行: 電源操作の統計(power_stats.c)
+#define HEF_ERASED          0x3FFF
+
+unsigned int hef_read(unsigned int addr);
+void hef_erase_row(unsigned int addr);
+void hef_write(unsigned int addr, const unsigned int *data, unsigned char count);
+void hef_write_bytes(unsigned int addr, const unsigned char *data, unsigned char count);
+
+#endif // _IR_REMOCON_ANALYZER_HEF_H_
@@ -0,0 +1,44 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_IR_PROTOCOL_H_
+#define _IR_REMOCON_ANALYZER_IR_PROTOCOL_H_
+
+// 受信・送信で共通のフォーマット定義
+
+#define T_NEC               562E-6      // NECフォーマットの単位時間, T=562us
+#define T_AEHA              425E-6      // 家製協フォーマットの単位時間, T=425us
+#define T_RC5               889E-6      // RC5の単位時間(半ビット), T=889us
+#define T_RC6               444E-6      // RC6の単位時間(半ビット), T=444us
+
+typedef enum {
+    IRR_TYPE_NEC = 0,
+    IRR_TYPE_AEHA,
+    IRR_TYPE_SONY,  // 未実装
+    IRR_TYPE_RC6,
+    IRR_TYPE_RC5,
+    IRR_TYPE_MAX,
+} irr_type_t;
+
+#endif // _IR_REMOCON_ANALYZER_IR_PROTOCOL_H_
@@ -25,31 +25,33 @@
 #include "common.h"
 #include "main.h"
 #include "ir_receiver.h"
+#include "settings.h"
+#include "trace.h"
+#include "clock.h"
+#include "debug_pin.h"
+#include "ir_transmitter.h"
 
 #pragma warning disable 2226    // advisory: (2226) large interrupt context save required for "_ir_receiver_pwa_isr"; consider reducing ISR complexity to lower the number of saved registers
 #pragma warning disable 520     // (520) function "_ir_receiver_set_mode" is never called
 
-//#define IRR_REPEAT_CHECK   // 2回連続で同じデータかのチェック
-
 #define SMTCLK              500E+3      // MFINTOSC(500kHz), CSEL=100
 #define SMTCLK_PS           1           // 1:1, PS=00
 #define TMRCLK              31.25E+3    // MFINTOSC(31.25kHz), CS=0110
 #define TMRCLK_PS           128         // 1:128, CKPS=111, OUTPS=0000
 
-#define T_NEC               562E-6      // NECフォーマットの単位時間, T=562us
-#define T_AEHA              425E-6      // 家製協フォーマットの単位時間, T=425us
-
-#define T_LEADER_COEFF_MIN  0.9
-#define T_LEADER_COEFF_MAX  1.1
+#define IRR_USE_RC5                     // Philips RC5(RC5X)のデコード
+#define IRR_USE_RC6                     // Philips RC6(モード0)のデコード
 
 #define DATA_MAXLEN         48          // 最大データ長
 #define DATA_EXTEND_MAX     4           // 連続してLeaderが来る場合の最大カウント
-#define DATA_MAXLEN_DEBUG   48          // デバッグ用の最大データ長
+#define MC_UNITS_MAX        3           // マンチェスター符号で同じレベルが続く最大の単位時間数
 
 #define SMT_COUNT(T)    ((int)(((double)(T)) * (SMTCLK / SMTCLK_PS)))           // 引数は定数で指定
 #define TMR_COUNT(T)    ((unsigned char)(((double)(T)) * (TMRCLK / TMRCLK_PS))) // 引数は定数で指定
 
 #define SMT_TIMEOUT         SMT_COUNT(T_NEC * 20)   // データの終了を判断する時間
+#define RC5_LEADER_MIN      SMT_COUNT(T_RC5 * 0.5)  // RC5の最初のH期間(1T または RC5XのS2=0の場合は2T)
+#define RC5_LEADER_MAX      SMT_COUNT(T_RC5 * 2.5)
 #define REPEAT_TIMEOUT      TMR_COUNT(300E-3)       // リピートの終了を判断する時間
 
 typedef enum {
@@ -58,12 +60,6 @@ typedef enum {
     IRR_STATE_DATA,
 } irr_state_t;
 
-typedef enum {
-    IRR_TYPE_NEC = 0,
-    IRR_TYPE_AEHA,
-    IRR_TYPE_SONY,  // 未実装
-} irr_type_t;
-
 typedef enum {
     IRR_ERROR_NONE = 0,
     IRR_ERROR_STATE_H,
@@ -74,6 +70,7 @@ typedef enum {
     IRR_ERROR_DATA_L,
     IRR_ERROR_DATA_CHECK,
     IRR_ERROR_DATA_OVERRUN,
+    IRR_ERROR_DATA_PHASE,
 } irr_error_t;
 
 typedef struct {
@@ -81,40 +78,29 @@ typedef struct {
     int max;
 } irr_minmax_t;
 
+#define IRR_FLAG_EXTEND     0x01        // Trailerの後に続きのフレームが来る(家製協)
+#define IRR_FLAG_GAP        0x02        // SMT1のタイムアウトの後(フレームの先頭)でのみリーダーを判定する
+#define IRR_NO_WIDE_BIT     0xFF
+
+// プロトコルごとのデコーダー
+// リーダー検出時に一度だけ選択し、以降のエッジはedgeの呼び出しのみで処理する
 typedef struct {
-    irr_minmax_t    leader_h;
-    irr_minmax_t    leader_l;
-    int             data_th;
+    char            (*leader)(int width_h);             // リーダーのH期間の判定。一致したら0以外
+    unsigned char   (*edge)(char mark, int width);      // H(mark=1)/L(mark=0)期間の処理。戻り値はtrace_edge_t
+    irr_error_t     (*validate)(void);                  // フレーム終了時のチェック
+    int             leader_h;       // リーダーのH期間(判定範囲は設定の係数から計算する)
+    int             leader_l;       // リーダーのL期間
+    int             data_th;        // パルス位置: 0/1の閾値, マンチェスター: 単位時間(半ビット)
     int             data_max;
-} irr_param_t;
+    unsigned char   flags;
+    unsigned char   mc_invert;      // マンチェスター: 0=後半がHなら1(RC5), 1=前半がHなら1(RC6)
+    unsigned char   mc_wide_bit;    // マンチェスター: 単位時間が2倍になるビット位置(RC6のトレーラービット)
+} irr_decoder_t;
 
-const irr_param_t irr_params[] = {
-    [IRR_TYPE_NEC] = {
-       .leader_h = { 
-            .min =  SMT_COUNT(T_NEC * 16 * T_LEADER_COEFF_MIN),
-            .max =  SMT_COUNT(T_NEC * 16 * T_LEADER_COEFF_MAX)
-        },
-       .leader_l = {
-            .min =  SMT_COUNT(T_NEC * 8 * T_LEADER_COEFF_MIN),
-            .max =  SMT_COUNT(T_NEC * 8 * T_LEADER_COEFF_MAX)
-        },
-       .data_th =   SMT_COUNT(T_NEC * 2                     ),
-       .data_max =  SMT_COUNT(T_NEC * 4                     ),
-    },
-    [IRR_TYPE_AEHA] = {
-       .leader_h = { 
-            .min =  SMT_COUNT(T_AEHA * 8 * T_LEADER_COEFF_MIN),
-            .max =  SMT_COUNT(T_AEHA * 8 * T_LEADER_COEFF_MAX)
-        },
-       .leader_l = {
-            .min =  SMT_COUNT(T_AEHA * 4 * T_LEADER_COEFF_MIN),
-            .max =  SMT_COUNT(T_AEHA * 4 * T_LEADER_COEFF_MAX)
-        },
-       .data_th =   SMT_COUNT(T_AEHA * 2                     ),
-       .data_max =  SMT_COUNT(T_AEHA * 4                     ),
-    }
-};
-#define PARAMS irr_params
+typedef struct {
+    irr_minmax_t    leader_h;
+    irr_minmax_t    leader_l;
+} irr_window_t;
 
 typedef struct {
     irr_type_t  type;
@@ -124,306 +110,643 @@ typedef struct {
     char        extended[DATA_EXTEND_MAX];
 } irr_data_analyze_result_t;
 
+typedef struct {
+    unsigned char               half;       // 前半の半ビットを受信済み
+    unsigned char               first;      // 前半の半ビットのレベル
+    unsigned char               count;      // 受信したビット数
+    unsigned long               bits;       // 受信したビット(MSBファースト)
+} irr_data_manchester_t;
+
 typedef struct {
     irr_state_t                 state;
     irr_error_t                 error;
     char                        received;
     char                        work_bitpos;
     char                        work_byte;
+    unsigned int                work_hash;      // 受信中フレームのハッシュ(1バイトごとに更新)
+    keycode_t                   confirm_key;    // 確定待ちのキー
+    unsigned int                confirm_hash;   // 確定待ちのフレームのハッシュ
+    unsigned char               confirm_count;  // 確定待ちのフレームの連続受信数
+    const irr_decoder_t         *decoder;
+    irr_data_manchester_t       mc;
     irr_data_analyze_result_t   work;
     irr_data_analyze_result_t   last;
 } irr_data_analyze_t;
 
+#ifdef IRR_CAPTURE_ENABLE
 typedef struct {
-    char                        l_length;
-    int                         l_time[DATA_MAXLEN_DEBUG];
-    char                        h_length;
-    int                         h_time[DATA_MAXLEN_DEBUG];
-} irr_data_measurement_t;
+    unsigned char               frozen;     // 記録済み。次のモード設定まで上書きしない
+    unsigned char               error;      // 記録したフレームのエラー
+    unsigned char               count;
+    unsigned int                width[IRR_CAPTURE_MAX];
+} irr_data_capture_t;
+#endif
 
 typedef struct {
-    volatile char               processing;
     irr_mode_t                  mode;
+    volatile irr_mode_t         mode_next;      // 次のフレームの先頭で反映するモード
+    volatile char               mode_pending;
+    char                        in_frame;       // フレームの受信中(最初のH期間〜SMT1のタイムアウト)
     int                         width_h;
     int                         width_l;
-    union {
-        irr_data_analyze_t      analyze;
-        irr_data_measurement_t  measurement;
-    } u;
+    irr_data_analyze_t          analyze;
+#ifdef IRR_CAPTURE_ENABLE
+    irr_data_capture_t          capture;
+#endif
 } irr_data_t;
 
 irr_data_t irr_data;
 #define DATA    irr_data
-#define DATA_A  DATA.u.analyze
-#define DATA_M  DATA.u.measurement
+#define DATA_A  DATA.analyze
+#define DATA_C  DATA.capture
+#define DEC     DATA_A.decoder
 
-void __interrupt(__flags(PEIE, SMT1PWAIE, SMT1PWAIF, 11))
-    ir_receiver_pwa_isr(void)
+irr_window_t irr_windows[IRR_TYPE_MAX];
+irr_stats_t irr_stats;
+#define WIN     irr_windows[DATA_A.work.type]
+
+#define SET_STATE(S)    do { DATA_A.state = (S); TRACE(TRACE_KIND_STATE | (S), 0); } while(0)
+#define SET_ERROR(E)    do { DATA_A.error = (E); TRACE(TRACE_KIND_ERROR | (E), 0); } while(0)
+
+static void irr_store_byte(char byte)
 {
-    SMT1PWAIF = 0;
-    DATA.width_h = SMT1CPWH << 8 | SMT1CPWL;
-    DATA.processing = 1;
+    if( DATA_A.work.length < DATA_MAXLEN )
+    {
+        DATA_A.work.data[DATA_A.work.length++] = byte;
+        // 左1ビットローテートとXORで、フレーム比較用のハッシュを受信しながら計算する
+        DATA_A.work_hash = ((DATA_A.work_hash << 1) | (DATA_A.work_hash >> 15)) ^ (unsigned char)byte;
+    }
+    else
+    {
+        SET_ERROR(IRR_ERROR_DATA_OVERRUN);
+    }
+}
 
-    if( COMMON.received == 0 )
+static void irr_reset_work(void)
+{
+    c_memzero(&DATA_A.work, sizeof(DATA_A.work));
+    c_memzero(&DATA_A.mc, sizeof(DATA_A.mc));
+    DATA_A.work_byte = 0;
+    DATA_A.work_bitpos = 0;
+    DATA_A.work_hash = 0;
+    DATA_A.error = IRR_ERROR_NONE;
+}
+
+static void irr_reset_confirm(void)
+{
+    DATA_A.confirm_key = KEYCODE_NONE;
+    DATA_A.confirm_hash = 0;
+    DATA_A.confirm_count = 0;
+}
+
+// キーの動作を確定してよいか判定する。
+// 同じキー・同じハッシュのフレームが設定回数だけ連続したら確定する
+static char irr_confirm(keycode_t key)
+{
+    unsigned char need;
+
+    if( key == DATA_A.confirm_key && DATA_A.work_hash == DATA_A.confirm_hash )
+    {
+        if( DATA_A.confirm_count < 0xFF )
+            DATA_A.confirm_count++;
+    }
+    else
+    {
+        DATA_A.confirm_key = key;
+        DATA_A.confirm_hash = DATA_A.work_hash;
+        DATA_A.confirm_count = 1;
+    }
+
+    need = SETTINGS_KEY_CONFIRM(key);
+    return DATA_A.confirm_count >= need;
+}
+
+// フレームの先頭の処理。モードの変更はここで反映する
+static void irr_frame_start(void)
+{
+    DATA.in_frame = 1;
+    if( DATA.mode_pending != 0 )
     {
-        if( DATA.mode == IRR_MODE_ANALIZE )
+        DATA.mode = DATA.mode_next;
+        DATA.mode_pending = 0;
+#ifdef IRR_CAPTURE_ENABLE
+        DATA_C.frozen = 0;
+#endif
+    }
+#ifdef IRR_CAPTURE_ENABLE
+    if( DATA_C.frozen == 0 )
+    {
+        DATA_C.count = 0;
+        DATA_C.error = IRR_ERROR_NONE;
+    }
+#endif
+}
+
+// デコードとは別に、フレームの幅をそのまま記録する
+static void irr_capture(unsigned int width)
+{
+#ifdef IRR_CAPTURE_ENABLE
+    if( DATA.mode != IRR_MODE_ANALIZE && DATA_C.frozen == 0 && DATA_C.count < IRR_CAPTURE_MAX )
+    {
+        DATA_C.width[DATA_C.count++] = width;
+    }
+#endif
+}
+
+// フレームの終わりの処理。記録の対象なら次のモード設定まで保持する
+static void irr_frame_end(irr_error_t error)
+{
+#ifdef IRR_CAPTURE_ENABLE
+    if( DATA.in_frame != 0 && DATA_C.frozen == 0 && DATA_C.count != 0 )
+    {
+        if(    DATA.mode == IRR_MODE_CAPTURE_ALL
+            || (DATA.mode == IRR_MODE_CAPTURE_FAILED && error != IRR_ERROR_NONE) )
         {
-            if( DATA_A.error != IRR_ERROR_NONE || DATA_A.received != 0 )
-                return;
+            DATA_C.error = error;
+            DATA_C.frozen = 1;
+        }
+    }
+#endif
+    DATA.in_frame = 0;
+}
 
-            switch( DATA_A.state )
-            {
-                case IRR_STATE_IDLE:
-                    if(    DATA.width_h >= PARAMS[IRR_TYPE_NEC].leader_h.min
-                        && DATA.width_h <= PARAMS[IRR_TYPE_NEC].leader_h.max )
-                    {
-                        DATA_A.work.type = IRR_TYPE_NEC;
-                        DATA_A.state = IRR_STATE_LEADER;
-                    }
-                    else if(    DATA.width_h >= PARAMS[IRR_TYPE_AEHA].leader_h.min
-                            && DATA.width_h <= PARAMS[IRR_TYPE_AEHA].leader_h.max )
-                    {
-                        DATA_A.work.type = IRR_TYPE_AEHA;
-                        DATA_A.state = IRR_STATE_LEADER;
-                    }
-                    else
-                    {
-                        DATA_A.error = IRR_ERROR_LEADER_H;
-                    }
-                    break;
+// Leader(H)+Leader(L)で始まるフォーマットのリーダー判定(NEC, 家製協, RC6)
+static char irr_leader(int width_h)
+{
+    if(    width_h >= WIN.leader_h.min
+        && width_h <= WIN.leader_h.max )
+    {
+        SET_STATE(IRR_STATE_LEADER);
+        return 1;
+    }
+    return 0;
+}
 
-                case IRR_STATE_DATA:
-                    if( DATA.width_h < PARAMS[DATA_A.work.type].data_th )
-                    {
-                        // OK。何もしない
-                    }
-                    else
-                    {
-                        DATA_A.error = IRR_ERROR_DATA_H;
-                    }
-                    break;
+// Leader(L)の判定
+static unsigned char irr_leader_l(int width_l)
+{
+    if(    width_l >= WIN.leader_l.min
+        && width_l <= WIN.leader_l.max )
+    {
+        SET_STATE(IRR_STATE_DATA);
+        return TRACE_EDGE_LEADER;
+    }
+    return TRACE_EDGE_OTHER;
+}
 
-                default:
-                    DATA_A.error = IRR_ERROR_STATE_H;
-                    break;
-            }
+// パルス位置(L期間の長さ)で0/1を表すフォーマット(NEC, 家製協)
+static unsigned char irr_pd_edge(char mark, int width)
+{
+    unsigned char edge;
+
+    if( mark )
+    {
+        if( DATA_A.state != IRR_STATE_DATA )
+        {
+            SET_ERROR(IRR_ERROR_STATE_H);
+            return TRACE_EDGE_OTHER;
         }
-        else if (DATA.mode == IRR_MODE_MEASUREMENT )
+        if( width < DEC->data_th )
         {
-            if( DATA_M.h_length < DATA_MAXLEN_DEBUG )
-                DATA_M.h_time[DATA_M.h_length++] = DATA.width_h;
+            // OK。何もしない
+            return TRACE_EDGE_DATA;
         }
-        else
+        SET_ERROR(IRR_ERROR_DATA_H);
+        return TRACE_EDGE_BAD;
+    }
+
+    if( DATA_A.state == IRR_STATE_LEADER )
+    {
+        if( irr_leader_l(width) == TRACE_EDGE_LEADER )
+            return TRACE_EDGE_LEADER;
+        SET_ERROR(IRR_ERROR_LEADER_L);
+        return TRACE_EDGE_BAD;
+    }
+
+    if( width < DEC->data_th )
+    {
+        edge = TRACE_EDGE_DATA0;
+        DATA_A.work_byte &= ~(1 << DATA_A.work_bitpos);
+    }
+    else if( width <= DEC->data_max )
+    {
+        edge = TRACE_EDGE_DATA1;
+        DATA_A.work_byte |= (1 << DATA_A.work_bitpos);
+    }
+    else
+    {
+        // 8ms以上のL期間(Trailer)の後に再度Leaderが来る場合は
+        // IDLEステートに戻して続きのデータを受信する
+        if( (DEC->flags & IRR_FLAG_EXTEND) != 0 && DATA_A.work.extended_count < DATA_EXTEND_MAX )
         {
+            DATA_A.work.extended[DATA_A.work.extended_count++] = DATA_A.work.length;
+            SET_STATE(IRR_STATE_IDLE);
+            return TRACE_EDGE_TRAILER;
         }
+        SET_ERROR(IRR_ERROR_DATA_L);
+        return TRACE_EDGE_BAD;
+    }
+
+    DATA_A.work_bitpos++;
+    if( DATA_A.work_bitpos >= 8 )
+    {
+        irr_store_byte(DATA_A.work_byte);
+        DATA_A.work_byte = 0;
+        DATA_A.work_bitpos = 0;
     }
+    return edge;
 }
 
-void __interrupt(__flags(PEIE, SMT1PRAIE, SMT1PRAIF, 12))
-    ir_receiver_pra_isr(void)
+static irr_error_t irr_nec_validate(void)
 {
-    SMT1PRAIF = 0;
-    DATA.width_l = SMT1CPRH << 8 | SMT1CPRL;
-    DATA.processing = 1;
+    if( DATA_A.work.length == 4 && DATA_A.work.data[2] == (DATA_A.work.data[3] ^ 0xFF) )
+        return IRR_ERROR_NONE;
+    return IRR_ERROR_DATA_CHECK;
+}
 
-    if( COMMON.received == 0 )
+static irr_error_t irr_aeha_validate(void)
+{
+    if(    DATA_A.work.length >= 4
+        && ((DATA_A.work.data[0] & 0x0F)
+            ^ ((DATA_A.work.data[0] >> 4) & 0x0F)
+            ^ (DATA_A.work.data[1] & 0x0F)
+            ^ ((DATA_A.work.data[1] >> 4) & 0x0F)) == (DATA_A.work.data[2] & 0x0F) )
+        return IRR_ERROR_NONE;
+    return IRR_ERROR_DATA_CHECK;
+}
+
+#if defined(IRR_USE_RC5) || defined(IRR_USE_RC6)
+// マンチェスター符号の半ビットを1つ処理する
+static char irr_mc_half(unsigned char mark)
+{
+    if( DATA_A.mc.half == 0 )
     {
-        if( DATA.mode == IRR_MODE_ANALIZE )
-        {
-            if( DATA_A.error != IRR_ERROR_NONE || DATA_A.received != 0 )
-                return;
+        DATA_A.mc.first = mark;
+        DATA_A.mc.half = 1;
+        return 1;
+    }
 
-            switch( DATA_A.state )
-            {
-                case IRR_STATE_LEADER:
-                    if(    DATA.width_l >= PARAMS[DATA_A.work.type].leader_l.min
-                        && DATA.width_l <= PARAMS[DATA_A.work.type].leader_l.max )
-                    {
-                        DATA_A.state = IRR_STATE_DATA;
-                    }
-                    break;
+    DATA_A.mc.half = 0;
+    if( DATA_A.mc.first == mark )
+    {
+        // ビットの中央で遷移がない
+        SET_ERROR(IRR_ERROR_DATA_PHASE);
+        return 0;
+    }
+    if( DATA_A.mc.count >= 32 )
+    {
+        SET_ERROR(IRR_ERROR_DATA_OVERRUN);
+        return 0;
+    }
+    DATA_A.mc.bits = (DATA_A.mc.bits << 1) | (mark ^ DEC->mc_invert);
+    DATA_A.mc.count++;
+    return 1;
+}
 
-                case IRR_STATE_DATA:
-                    if( DATA.width_l < PARAMS[DATA_A.work.type].data_th )
-                    {
-                        DATA_A.work_byte &= ~(1 << DATA_A.work_bitpos);
-                    }
-                    else if(    DATA.width_l >= PARAMS[DATA_A.work.type].data_th
-                             && DATA.width_l <= PARAMS[DATA_A.work.type].data_max )
-                    {
-                        DATA_A.work_byte |= (1 << DATA_A.work_bitpos);
-                    }
-                    else
-                    {
-                        if( DATA_A.work.type == IRR_TYPE_AEHA )
-                        {
-                            // 8ms以上のL期間(Trailer)の後に再度Leaderが来る場合は
-                            // IDLEステートに戻して続きのデータを受信する
-                            if( DATA_A.work.extended_count < DATA_EXTEND_MAX )
-                            {
-                                DATA_A.work.extended[DATA_A.work.extended_count++] = DATA_A.work.length;
-                                DATA_A.state = IRR_STATE_IDLE;
-                            }
-                            else
-                            {
-                                DATA_A.error = IRR_ERROR_DATA_L;
-                            }
-                        }
-                        else
-                        {
-                            DATA_A.error = IRR_ERROR_DATA_L;
-                        }
-                        break;
-                    }
-                    DATA_A.work_bitpos++;
-                    if( DATA_A.work_bitpos >= 8 )
-                    {
-                        if( DATA_A.work.length < DATA_MAXLEN )
-                        {
-                            DATA_A.work.data[DATA_A.work.length++] = DATA_A.work_byte;
-                        }
-                        else
-                        {
-                            DATA_A.error = IRR_ERROR_DATA_OVERRUN;
-                        }
-                        DATA_A.work_byte = 0;
-                        DATA_A.work_bitpos = 0;
-                    }
-                    break;
+// マンチェスター符号(RC5, RC6)
+static unsigned char irr_mc_edge(char mark, int width)
+{
+    unsigned char units = 0;
+    unsigned char need;
+    int unit = DEC->data_th;
 
-                default:
-                    DATA_A.error = IRR_ERROR_STATE_L;
-                    break;
-            }
+    if( DATA_A.state == IRR_STATE_LEADER )
+    {
+        if( mark )
+        {
+            SET_ERROR(IRR_ERROR_STATE_H);
+            return TRACE_EDGE_OTHER;
         }
-        else if( DATA.mode == IRR_MODE_MEASUREMENT )
+        if( irr_leader_l(width) == TRACE_EDGE_LEADER )
+            return TRACE_EDGE_LEADER;
+        SET_ERROR(IRR_ERROR_LEADER_L);
+        return TRACE_EDGE_BAD;
+    }
+
+    // 期間を単位時間の数に丸める(除算を使わない)
+    width += unit >> 1;
+    while( width >= unit && units <= MC_UNITS_MAX )
+    {
+        width -= unit;
+        units++;
+    }
+    if( units == 0 || units > MC_UNITS_MAX )
+    {
+        SET_ERROR(mark ? IRR_ERROR_DATA_H : IRR_ERROR_DATA_L);
+        return TRACE_EDGE_BAD;
+    }
+
+    while( units > 0 )
+    {
+        need = (DATA_A.mc.count == DEC->mc_wide_bit) ? 2 : 1;
+        if( units < need )
         {
-            if( DATA_M.l_length < DATA_MAXLEN_DEBUG )
-                DATA_M.l_time[DATA_M.l_length++] = DATA.width_l;
+            SET_ERROR(mark ? IRR_ERROR_DATA_H : IRR_ERROR_DATA_L);
+            return TRACE_EDGE_BAD;
         }
-        else
+        units -= need;
+        if( irr_mc_half(mark != 0) == 0 )
+            return TRACE_EDGE_BAD;
+    }
+    return TRACE_EDGE_DATA;
+}
+
+// フレーム終了時の処理
+// 最後のL期間は次のHが来ないため測定されない。前半だけ受信したビットを補完する
+static void irr_mc_flush(void)
+{
+    if( DATA_A.mc.half != 0 )
+    {
+        irr_mc_half(DATA_A.mc.first ^ 1);
+    }
+}
+#endif
+
+#ifdef IRR_USE_RC6
+// RC6(モード0): Start(1), Mode(3), Trailer(1, 2倍幅), Address(8), Command(8)
+// data[0]=Mode, data[1]=Toggle, data[2]=Address, data[3]=Command
+static irr_error_t irr_rc6_validate(void)
+{
+    irr_mc_flush();
+    if( DATA_A.error != IRR_ERROR_NONE )
+        return DATA_A.error;
+    if( DATA_A.mc.count != 21 || ((DATA_A.mc.bits >> 20) & 1) == 0 )
+        return IRR_ERROR_DATA_CHECK;
+
+    irr_store_byte((DATA_A.mc.bits >> 17) & 0x07);
+    irr_store_byte((DATA_A.mc.bits >> 16) & 0x01);
+    irr_store_byte((DATA_A.mc.bits >> 8) & 0xFF);
+    irr_store_byte(DATA_A.mc.bits & 0xFF);
+    return IRR_ERROR_NONE;
+}
+#endif
+
+#ifdef IRR_USE_RC5
+// RC5の最初のH期間はS1の後半
+// S1の前半(L)はアイドルと区別できないので受信済みとして扱う
+static char irr_rc5_leader(int width_h)
+{
+    if(    width_h >= RC5_LEADER_MIN
+        && width_h <= RC5_LEADER_MAX )
+    {
+        DATA_A.mc.first = 0;
+        DATA_A.mc.half = 1;
+        SET_STATE(IRR_STATE_DATA);
+        return irr_mc_edge(1, width_h) != TRACE_EDGE_BAD;
+    }
+    return 0;
+}
+
+// RC5(RC5X): S1(1), S2(1, RC5XではCommandのbit6の反転), Toggle(1), Address(5), Command(6)
+// data[0]=Address, data[1]=Command(7bit), data[2]=Toggle
+static irr_error_t irr_rc5_validate(void)
+{
+    irr_mc_flush();
+    if( DATA_A.error != IRR_ERROR_NONE )
+        return DATA_A.error;
+    if( DATA_A.mc.count != 14 || ((DATA_A.mc.bits >> 13) & 1) == 0 )
+        return IRR_ERROR_DATA_CHECK;
+
+    irr_store_byte((DATA_A.mc.bits >> 6) & 0x1F);
+    irr_store_byte((DATA_A.mc.bits & 0x3F) | ((((DATA_A.mc.bits >> 12) & 1) ^ 1) << 6));
+    irr_store_byte((DATA_A.mc.bits >> 11) & 0x01);
+    return IRR_ERROR_NONE;
+}
+#endif
+
+const irr_decoder_t irr_decoders[IRR_TYPE_MAX] = {
+    [IRR_TYPE_NEC] = {
+        .leader =   irr_leader,
+        .edge =     irr_pd_edge,
+        .validate = irr_nec_validate,
+        .leader_h = SMT_COUNT(T_NEC * 16),
+        .leader_l = SMT_COUNT(T_NEC * 8),
+        .data_th =  SMT_COUNT(T_NEC * 2),
+        .data_max = SMT_COUNT(T_NEC * 4),
+        .mc_wide_bit = IRR_NO_WIDE_BIT,
+    },
+    [IRR_TYPE_AEHA] = {
+        .leader =   irr_leader,
+        .edge =     irr_pd_edge,
+        .validate = irr_aeha_validate,
+        .leader_h = SMT_COUNT(T_AEHA * 8),
+        .leader_l = SMT_COUNT(T_AEHA * 4),
+        .data_th =  SMT_COUNT(T_AEHA * 2),
+        .data_max = SMT_COUNT(T_AEHA * 4),
+        .flags =    IRR_FLAG_EXTEND,
+        .mc_wide_bit = IRR_NO_WIDE_BIT,
+    },
+#ifdef IRR_USE_RC6
+    [IRR_TYPE_RC6] = {
+        .leader =   irr_leader,
+        .edge =     irr_mc_edge,
+        .validate = irr_rc6_validate,
+        .leader_h = SMT_COUNT(T_RC6 * 6),
+        .leader_l = SMT_COUNT(T_RC6 * 2),
+        .data_th =  SMT_COUNT(T_RC6),
+        .flags =    IRR_FLAG_GAP,
+        .mc_invert = 1,
+        .mc_wide_bit = 4,
+    },
+#endif
+#ifdef IRR_USE_RC5
+    // リーダーがないため最初のH期間で判定する
+    [IRR_TYPE_RC5] = {
+        .leader =   irr_rc5_leader,
+        .edge =     irr_mc_edge,
+        .validate = irr_rc5_validate,
+        .data_th =  SMT_COUNT(T_RC5),
+        .flags =    IRR_FLAG_GAP,
+        .mc_wide_bit = IRR_NO_WIDE_BIT,
+    },
+#endif
+};
+#define DECODERS irr_decoders
+
+void __interrupt(__flags(PEIE, SMT1PWAIE, SMT1PWAIF, 11))
+    ir_receiver_pwa_isr(void)
+{
+    unsigned char edge = TRACE_EDGE_OTHER;
+    unsigned char type;
+    unsigned char first;
+
+    DEBUG_ENTER(DEBUG_SRC_PWA);
+    SMT1PWAIF = 0;
+    clock_fast();
+    DATA.width_h = SMT1CPWH << 8 | SMT1CPWL;
+
+    first = DATA.in_frame == 0;
+    if( first )
+        irr_frame_start();
+    irr_capture(DATA.width_h | IRR_CAPTURE_MARK);
+
+    if( COMMON.received == 0 )
+    {
+        if( DATA_A.error == IRR_ERROR_NONE && DATA_A.received == 0 )
         {
+            if( DATA_A.state == IRR_STATE_IDLE )
+            {
+                // リーダー検出時のみ全デコーダーを試す
+                // 家製協のTrailerの後などフレームの途中では、IRR_FLAG_GAPのデコーダーは試さない
+                for( type = 0; type < IRR_TYPE_MAX; type++ )
+                {
+                    DEC = &DECODERS[type];
+                    DATA_A.work.type = type;
+                    if( DEC->leader == 0 )
+                        continue;
+                    if( first == 0 && (DEC->flags & IRR_FLAG_GAP) != 0 )
+                        continue;
+                    if( DEC->leader(DATA.width_h) != 0 )
+                        break;
+                }
+                if( type < IRR_TYPE_MAX )
+                {
+                    edge = TRACE_EDGE_LEADER;
+                }
+                else
+                {
+                    edge = TRACE_EDGE_BAD;
+                    SET_ERROR(IRR_ERROR_LEADER_H);
+                }
+            }
+            else
+            {
+                edge = DEC->edge(1, DATA.width_h);
+            }
+            TRACE_EDGE(TRACE_KIND_EDGE_H, edge, DATA.width_h);
         }
     }
 
+    DEBUG_EXIT(DEBUG_SRC_PWA);
+}
+
+void __interrupt(__flags(PEIE, SMT1PRAIE, SMT1PRAIF, 12))
+    ir_receiver_pra_isr(void)
+{
+    unsigned char edge = TRACE_EDGE_OTHER;
+
+    DEBUG_ENTER(DEBUG_SRC_PRA);
+    SMT1PRAIF = 0;
+    clock_fast();
+    DATA.width_l = SMT1CPRH << 8 | SMT1CPRL;
+
+    if( DATA.in_frame != 0 )
+        irr_capture(DATA.width_l);
+
+    if( COMMON.received == 0 )
+    {
+        if( DATA_A.error == IRR_ERROR_NONE && DATA_A.received == 0 )
+        {
+            if( DATA_A.state == IRR_STATE_IDLE )
+            {
+                SET_ERROR(IRR_ERROR_STATE_L);
+            }
+            else
+            {
+                edge = DEC->edge(0, DATA.width_l);
+            }
+            TRACE_EDGE(TRACE_KIND_EDGE_L, edge, DATA.width_l);
+        }
+    }
+    DEBUG_EXIT(DEBUG_SRC_PRA);
 }
 
 void __interrupt(__flags(PEIE, SMT1IE, SMT1IF, 13))
     ir_receiver_isr(void)
 {
+    irr_error_t error;
+    irr_error_t result;
+    keycode_t key;
+
+    DEBUG_ENTER(DEBUG_SRC_FRAME);
     SMT1IF = 0;
-    DATA.processing = 1;
 
+    result = IRR_ERROR_NONE;
     if( COMMON.received == 0 )
     {
-        if( DATA.mode == IRR_MODE_ANALIZE )
+        if( DATA_A.received == 0 )
         {
-            if( DATA_A.received == 0 )
+            if( ir_transmitter_busy() != 0 )
             {
-                if( DATA_A.error == IRR_ERROR_NONE && DATA_A.state == IRR_STATE_DATA )
+                // 送信中は自分の送信を受信しているので捨てる
+            }
+            else if( DATA_A.error == IRR_ERROR_NONE && DATA_A.state == IRR_STATE_DATA )
+            {
+                // 受信成功
+                error = DEC->validate();
+                if( error != IRR_ERROR_NONE && DATA_A.error == IRR_ERROR_NONE )
                 {
-                    // 受信成功
-                    if( DATA_A.work.type == IRR_TYPE_NEC && DATA_A.work.length == 4 )
-                    {
-                        if( DATA_A.work.data[2] != (DATA_A.work.data[3] ^ 0xFF) )
-                        {
-                            DATA_A.error = IRR_ERROR_DATA_CHECK;
-                        }
-                    }
-                    else if( DATA_A.work.type == IRR_TYPE_AEHA && DATA_A.work.length >= 4 )
-                    {
-                        if( ((DATA_A.work.data[0] & 0x0F)
-                            ^ ((DATA_A.work.data[0] >> 4) & 0x0F)
-                            ^ (DATA_A.work.data[1] & 0x0F)
-                            ^ ((DATA_A.work.data[1] >> 4) & 0x0F)) != (DATA_A.work.data[2] & 0x0F) )
-                        {
-                            DATA_A.error = IRR_ERROR_DATA_CHECK;
-                        }
-                    }
-                    else
-                    {
-                        DATA_A.error = IRR_ERROR_DATA_CHECK;
-                    }
+                    SET_ERROR(error);
+                }
 
-                    if( DATA_A.error == IRR_ERROR_NONE )
+                if( DATA_A.error == IRR_ERROR_NONE )
+                {
+                    irr_stats.frames++;
+                    irr_stats.last_type = DATA_A.work.type;
+                    if( DATA_A.work.length != 0 )
                     {
-                        if( DATA_A.work.length != 0 )
+                        // コード確認(data[3]はdata[2]の反転であることを確認済み)
+                        COMMON.keycode = KEYCODE_NONE;
+                        if ( DATA_A.work.type == IRR_TYPE_NEC && DATA_A.work.length == 4 )
                         {
-#ifdef IRR_REPEAT_CHECK
-                            // 2回連続で同じデータを受信した場合は受信完了
-                            if( c_memcmp(&DATA_A.last, &DATA_A.work, sizeof(DATA_A.work)) == 0 )
+                            if(    DATA_A.work.data[0] == SETTINGS.key_custom[0]
+                                && DATA_A.work.data[1] == SETTINGS.key_custom[1] )
                             {
-                                DATA_A.received = 1;
-                                COMMON.received = 1;
-                            }
-#else
-                            // コード確認
-                            COMMON.keycode = KEYCODE_NONE;
-                            if ( DATA_A.work.type == IRR_TYPE_NEC && DATA_A.work.length == 4 )
-                            {
-                                // Nature Remo Preset: NEC LIGHT 201
-                                if( DATA_A.work.data[0] == 0x82 && DATA_A.work.data[1] == 0x6d )
+                                for( key = KEYCODE_OFF; key < KEYCODE_MAX; key++ )
                                 {
-                                    if( DATA_A.work.data[2] == 0xbe && DATA_A.work.data[3] == 0x41 )
-                                    {
-                                        COMMON.keycode = KEYCODE_OFF;
-                                    }
-                                    else if ( DATA_A.work.data[2] == 0xbd && DATA_A.work.data[3] == 0x42 )
-                                    {
-                                        COMMON.keycode = KEYCODE_FAVORITE;
-                                    }
-                                    else if ( DATA_A.work.data[2] == 0xbc && DATA_A.work.data[3] == 0x43 )
-                                    {
-                                        COMMON.keycode = KEYCODE_NIGHTLIGHT;
-                                    }
-                                    else if ( DATA_A.work.data[2] == 0xbb && DATA_A.work.data[3] == 0x44 )
-                                    {
-                                        COMMON.keycode = KEYCODE_MINUS;
-                                    }
-                                    else if ( DATA_A.work.data[2] == 0xba && DATA_A.work.data[3] == 0x45 )
-                                    {
-                                        COMMON.keycode = KEYCODE_PLUS;
-                                    }
-                                    else if ( DATA_A.work.data[2] == 0xa6 && DATA_A.work.data[3] == 0x59 )
+                                    if( DATA_A.work.data[2] == SETTINGS.key_data[key - KEYCODE_OFF] )
                                     {
-                                        COMMON.keycode = KEYCODE_ALL;
+                                        COMMON.keycode = key;
+                                        break;
                                     }
                                 }
                             }
-                            if( COMMON.keycode != KEYCODE_NONE )
+                        }
+                        TRACE(TRACE_KIND_KEYCODE | COMMON.keycode, DATA_A.work.data[2]);
+                        if( COMMON.keycode != KEYCODE_NONE )
+                        {
+                            // キーごとに設定されたフレーム数だけ同じデータが続いたら受信完了
+                            if( irr_confirm(COMMON.keycode) )
                             {
+                                irr_stats.keys++;
                                 DATA_A.received = 1;
                                 COMMON.received = 1;
                             }
-#endif  // IRR_REPEAT_CHECK
                         }
-                        c_memcopy(&DATA_A.last, &DATA_A.work, sizeof(DATA_A.last));
-                    }
-                    else
-                    {
-                        // データチェック失敗
+                        else
+                        {
+                            irr_reset_confirm();
+#ifdef IRT_RELAY
+                            // キーコードに割り当てのないフレームはそのまま送信する
+                            // (複数のフレームは1フレームとしては送れないので中継しない)
+                            if( DATA_A.work.extended_count == 0 )
+                                ir_transmitter_send(DATA_A.work.type, DATA_A.work.data, DATA_A.work.length);
+#endif
+                        }
                     }
+                    c_memcopy(&DATA_A.last, &DATA_A.work, sizeof(DATA_A.last));
                 }
                 else
                 {
-                    // 受信失敗
+                    // データチェック失敗
+                    result = DATA_A.error;
+                    irr_stats.errors++;
+                    irr_stats.last_error = DATA_A.error;
                 }
-
-                c_memzero(&DATA_A.work, sizeof(DATA_A.work));
-                DATA_A.work_byte = 0;
-                DATA_A.work_bitpos = 0;
-                DATA_A.error = IRR_ERROR_NONE;
-                DATA_A.state = IRR_STATE_IDLE;
             }
-        }
-        else if( DATA.mode == IRR_MODE_MEASUREMENT )
-        {
-            COMMON.received = 1;
-        }
-        else
-        {
+            else if( DATA_A.error != IRR_ERROR_NONE )
+            {
+                // 受信失敗
+                result = DATA_A.error;
+                irr_stats.errors++;
+                irr_stats.last_error = DATA_A.error;
+            }
+
+            irr_reset_work();
+            SET_STATE(IRR_STATE_IDLE);
         }
     }
+    irr_frame_end(result);
 
     SMT1CON1bits.GO = 0;
     SMT1STAT = 0xD0;
@@ -433,41 +756,104 @@ void __interrupt(__flags(PEIE, SMT1IE, SMT1IF, 13))
     T4CONbits.ON = 0;
     T4TMR = 0x00;
     T4CONbits.ON = 1;
+    DEBUG_EXIT(DEBUG_SRC_FRAME);
 }
 
 void __interrupt(__flags(PEIE, TMR4IE, TMR4IF, 10))
     ir_receiver_tmr_isr(void)
 {
+    DEBUG_ENTER(DEBUG_SRC_TIMEOUT);
     TMR4IF = 0;
-    if( DATA.mode == IRR_MODE_ANALIZE )
-    {
-        c_memzero(&DATA_A.work, sizeof(DATA_A.work));
-        DATA_A.work_byte = 0;
-        DATA_A.work_bitpos = 0;
-        DATA_A.error = IRR_ERROR_NONE;
-        DATA_A.state = IRR_STATE_IDLE;
-        DATA_A.received = 0;
-    }
-    else if ( DATA.mode == IRR_MODE_MEASUREMENT )
-    {
-        DATA_M.l_length = 0;
-        DATA_M.h_length = 0;
-    }
-    else
+    TRACE(TRACE_KIND_TIMEOUT, 0);
+    clock_idle();
+    irr_reset_work();
+    irr_reset_confirm();
+    DATA_A.state = IRR_STATE_IDLE;
+    DATA_A.received = 0;
+    DATA.in_frame = 0;
+    DEBUG_EXIT(DEBUG_SRC_TIMEOUT);
+}
+
+// モードは次のフレームの先頭で反映する(受信中のフレームは前のモードのまま)。
+// 同じモードを設定すると、保持している記録を解除して次の記録を待つ
+void ir_receiver_set_mode(irr_mode_t mode)
+{
+    DATA.mode_next = mode;
+    DATA.mode_pending = 1;
+}
+
+// 最後に受信したフレームを取得する。戻り値はデータ長(受信していない場合は0)
+// 複数のフレームの区切りは返さないので、IRR_LAST_MULTIのデータはそのまま送信できない
+char ir_receiver_get_last(irr_type_t *type, unsigned char *flags, char *data, char max)
+{
+    char length;
+
+    *flags = 0;
+    length = DATA_A.last.length;
+    if( length > max )
     {
+        length = max;
+        *flags |= IRR_LAST_TRUNCATED;
     }
+    if( DATA_A.last.extended_count != 0 )
+        *flags |= IRR_LAST_MULTI;
+    *type = DATA_A.last.type;
+    c_memcopy(data, DATA_A.last.data, length);
+    return length;
+}
 
-    DATA.processing = 0;
+#ifdef IRR_CAPTURE_ENABLE
+// 記録したフレームの幅を取得する。戻り値は取得した幅の数
+unsigned char ir_receiver_get_capture(irr_capture_info_t *info, unsigned char index, unsigned int *width, unsigned char max)
+{
+    unsigned char count;
+
+    info->mode = DATA.mode_pending != 0 ? DATA.mode_next : DATA.mode;
+    info->frozen = DATA_C.frozen;
+    info->error = DATA_C.error;
+    info->count = DATA_C.frozen != 0 ? DATA_C.count : 0;
+
+    if( index >= info->count )
+        return 0;
+    count = info->count - index;
+    if( count > max )
+        count = max;
+    c_memcopy(width, &DATA_C.width[index], count * sizeof(DATA_C.width[0]));
+    return count;
 }
+#endif
 
-void ir_receiver_set_mode(irr_mode_t mode)
+// リーダーの判定範囲を設定の係数から計算する
+static void irr_calc_window(irr_window_t *window, unsigned char type)
 {
-    while( DATA.processing != 0 );
-    DATA.mode = mode;
+    window->leader_h.min = (long)DECODERS[type].leader_h * SETTINGS.leader_coeff_min / 100;
+    window->leader_h.max = (long)DECODERS[type].leader_h * SETTINGS.leader_coeff_max / 100;
+    window->leader_l.min = (long)DECODERS[type].leader_l * SETTINGS.leader_coeff_min / 100;
+    window->leader_l.max = (long)DECODERS[type].leader_l * SETTINGS.leader_coeff_max / 100;
+}
+
+// リーダーの判定範囲を設定の係数から計算し直す(係数の設定の書き込み後に呼ぶ)
+// 計算は割り込みを許可したまま行い、SMT1の割り込みは1つ分のコピーの間だけ止める
+void ir_receiver_update_windows(void)
+{
+    irr_window_t window;
+    unsigned char type;
+
+    for( type = 0; type < IRR_TYPE_MAX; type++ )
+    {
+        irr_calc_window(&window, type);
+        PIE8bits.SMT1PWAIE = 0;
+        PIE8bits.SMT1PRAIE = 0;
+        c_memcopy(&irr_windows[type], &window, sizeof(window));
+        PIE8bits.SMT1PWAIE = 1;
+        PIE8bits.SMT1PRAIE = 1;
+    }
 }
 
 void ir_receiver_init(void)
 {
+    unsigned char type;
+
     SMT1CON0 = 0x08;    // EN=0, (0), STP=0, WPOL=0, SPOL=1, CPOL=0, PS=00 ... 1:1
     SMT1CON1 = 0x43;    // GO=0, REPEAT=1, (0), (0), MODE=0011 (High and Low Measurement Mode)
     SMT1STAT = 0xD0;    // CPRUP=1, CPWUP=1, (0), RST=1, (0), (TS=0), (WS=0), (AS=0)
@@ -492,6 +878,8 @@ void ir_receiver_init(void)
 
     c_memzero(&DATA, sizeof(DATA));
     DATA.mode = IRR_MODE_ANALIZE;
+    for( type = 0; type < IRR_TYPE_MAX; type++ )
+        irr_calc_window(&irr_windows[type], type);
 
     PIR4bits.TMR4IF = 0;
     PIE4bits.TMR4IE = 1;
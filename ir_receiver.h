@@ -25,12 +25,48 @@
 #ifndef _IR_REMOCON_ANALYZER_IR_RECEIVER_H_
 #define _IR_REMOCON_ANALYZER_IR_RECEIVER_H_
 
+#include "ir_protocol.h"
+
+//#define IRR_CAPTURE_ENABLE          // 受信したフレームの幅の記録(RAMを約140バイト使うので既定では無効)
+
+#define IRR_CAPTURE_MAX     68          // 記録するH/L期間の最大数(NECの1フレーム67期間が収まる数)
+#define IRR_CAPTURE_MARK    0x8000      // 記録した幅のH期間を示すビット(幅は2us単位)
+
+// デコードは常に行い、モードでは生の幅の記録(キャプチャー)の対象を選ぶ
 typedef enum {
-    IRR_MODE_ANALIZE = 0,
-    IRR_MODE_MEASUREMENT,
+    IRR_MODE_ANALIZE = 0,           // デコードのみ
+    IRR_MODE_CAPTURE_FAILED,        // デコードに失敗したフレームを記録する
+    IRR_MODE_CAPTURE_ALL,           // すべてのフレームを記録する
+    IRR_MODE_MAX,
 } irr_mode_t;
 
+typedef struct {
+    unsigned char   mode;           // irr_mode_t(変更の反映待ちの場合は次のモード)
+    unsigned char   frozen;         // 1=記録済み(次のモード設定まで保持する)
+    unsigned char   error;          // 記録したフレームのエラー(0=デコード成功)
+    unsigned char   count;          // 記録したH/L期間の数(記録済みでない場合は0)
+} irr_capture_info_t;
+
+// ir_receiver_get_lastのフラグ
+#define IRR_LAST_TRUNCATED  0x01        // 取得できる長さを超えたので切り詰めた
+#define IRR_LAST_MULTI      0x02        // 複数のフレーム(家製協のTrailerの後の続き)を連結した
+
+typedef struct {
+    unsigned int    frames;         // デコードに成功したフレーム数
+    unsigned int    keys;           // キーコードを通知した回数
+    unsigned int    errors;         // デコードに失敗したフレーム数
+    unsigned char   last_type;      // 最後に成功したフレームのフォーマット
+    unsigned char   last_error;     // 最後に失敗したフレームのエラー
+} irr_stats_t;
+
+extern irr_stats_t irr_stats;
+
 void ir_receiver_set_mode(irr_mode_t mode);
+char ir_receiver_get_last(irr_type_t *type, unsigned char *flags, char *data, char max);
+#ifdef IRR_CAPTURE_ENABLE
+unsigned char ir_receiver_get_capture(irr_capture_info_t *info, unsigned char index, unsigned int *width, unsigned char max);
+#endif
+void ir_receiver_update_windows(void);
 void ir_receiver_init(void);
 
 #endif // _IR_REMOCON_ANALYZER_IR_RECEIVER_H_
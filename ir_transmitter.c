@@ -0,0 +1,233 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "ir_transmitter.h"
+#include "clock.h"
+
+#ifdef IRT_ENABLE
+
+// キャリア: TMR2(MFINTOSC 500kHz, PR=12)のPWM6で38.5kHz, デューティ1/3
+// 変調:     CLC1(4入力AND)でPWM6とG2POLのANDを取り、G2POLでH/Lを切り替える
+// 時間:     TMR6(MFINTOSC 500kHz, 1:8)の周期でH/Lの期間を作る
+// いずれもMFINTOSCを使うので、システムクロックの影響を受けない
+#define IRT_TMRCLK          62.5E+3     // MFINTOSC(500kHz), CS=0101, 1:8
+#define IRT_COUNT(T)        ((unsigned int)(((double)(T)) * IRT_TMRCLK + 0.5))   // 引数は定数で指定
+#define IRT_CHUNK_MAX       250         // TMR6の1周期の最大カウント
+#define IRT_GAP             IRT_COUNT(20E-3)    // 送信後の間隔。自分の送信を受信して中継し続けないよう、受信のタイムアウトより長くする
+
+#define IRT_CLCSEL_PWM6     0x18        // CLCxSELのPWM6OUT(データシートのCLCx Data Input Selectionの表を参照)
+#define IRT_CLCPOL_MARK     0x0E        // POL=0, G4POL=1, G3POL=1, G2POL=1, G1POL=0
+#define IRT_CLCPOL_SPACE    0x0C        // POL=0, G4POL=1, G3POL=1, G2POL=0, G1POL=0
+
+typedef struct {
+    unsigned int    leader_h;
+    unsigned int    leader_l;
+    unsigned int    t;
+} irt_param_t;
+
+const irt_param_t irt_params[] = {
+    [IRR_TYPE_NEC] = {
+        .leader_h = IRT_COUNT(T_NEC * 16),
+        .leader_l = IRT_COUNT(T_NEC * 8),
+        .t =        IRT_COUNT(T_NEC),
+    },
+    [IRR_TYPE_AEHA] = {
+        .leader_h = IRT_COUNT(T_AEHA * 8),
+        .leader_l = IRT_COUNT(T_AEHA * 4),
+        .t =        IRT_COUNT(T_AEHA),
+    },
+};
+
+typedef struct {
+    volatile char   busy;
+    irr_type_t      type;
+    char            length;
+    char            data[IRT_DATA_MAX];
+    unsigned int    segment;    // 0: Leader(H), 1: Leader(L), 2〜: データ(H/L), 最後: Stop(H), 間隔(L)
+    unsigned int    remaining;  // 現在の期間の残りカウント
+} irt_data_t;
+
+irt_data_t irt_data;
+#define IRT     irt_data
+#define PARAM   irt_params[IRT.type]
+
+// 次の期間を開始する。送信が終わったら0を返す
+static char irt_next_segment(void)
+{
+    unsigned int seg = IRT.segment++;
+    unsigned int bits = (unsigned int)IRT.length * 8;
+    unsigned int bit;
+
+    if( seg == 0 )
+    {
+        CLC1POL = IRT_CLCPOL_MARK;
+        IRT.remaining = PARAM.leader_h;
+    }
+    else if( seg == 1 )
+    {
+        CLC1POL = IRT_CLCPOL_SPACE;
+        IRT.remaining = PARAM.leader_l;
+    }
+    else if( seg < 2 + bits * 2 )
+    {
+        // LSBファースト。0: H=T, L=T, 1: H=T, L=3T
+        seg -= 2;
+        bit = seg >> 1;
+        if( (seg & 1) == 0 )
+        {
+            CLC1POL = IRT_CLCPOL_MARK;
+            IRT.remaining = PARAM.t;
+        }
+        else
+        {
+            CLC1POL = IRT_CLCPOL_SPACE;
+            IRT.remaining = (IRT.data[bit >> 3] & (1 << (bit & 7))) ? PARAM.t * 3 : PARAM.t;
+        }
+    }
+    else if( seg == 2 + bits * 2 )
+    {
+        CLC1POL = IRT_CLCPOL_MARK;
+        IRT.remaining = PARAM.t;
+    }
+    else if( seg == 3 + bits * 2 )
+    {
+        CLC1POL = IRT_CLCPOL_SPACE;
+        IRT.remaining = IRT_GAP;
+    }
+    else
+    {
+        return 0;
+    }
+    return 1;
+}
+
+static void irt_load_chunk(void)
+{
+    unsigned char chunk = (IRT.remaining > IRT_CHUNK_MAX) ? IRT_CHUNK_MAX : IRT.remaining;
+
+    IRT.remaining -= chunk;
+    T6PR = chunk - 1;
+}
+
+void __interrupt(__flags(PEIE, TMR6IE, TMR6IF, 16))
+    ir_transmitter_isr(void)
+{
+    TMR6IF = 0;
+
+    if( IRT.remaining == 0 )
+    {
+        if( irt_next_segment() == 0 )
+        {
+            T6CONbits.ON = 0;
+            IRT.busy = 0;
+            clock_release();
+            return;
+        }
+    }
+    irt_load_chunk();
+}
+
+// 割り込み処理内から呼ぶこと。送信中の場合は0を返す
+char ir_transmitter_send(irr_type_t type, const char *data, char length)
+{
+    if( IRT.busy != 0 || length == 0 || length > IRT_DATA_MAX )
+        return 0;
+    if( type != IRR_TYPE_NEC && type != IRR_TYPE_AEHA )
+        return 0;
+
+    // 低速ではTMR6の割り込みの処理が間に合わない
+    clock_hold();
+    IRT.busy = 1;
+    IRT.type = type;
+    IRT.length = length;
+    c_memcopy(IRT.data, data, length);
+    IRT.segment = 0;
+    irt_next_segment();
+    irt_load_chunk();
+
+    T6TMR = 0;
+    TMR6IF = 0;
+    T6CONbits.ON = 1;
+    return 1;
+}
+
+char ir_transmitter_busy(void)
+{
+    return IRT.busy;
+}
+
+void ir_transmitter_init(void)
+{
+    c_memzero(&IRT, sizeof(IRT));
+
+    // キャリア
+    T2CON = 0x00;       // ON=0, CKPS=000 ... 1:1, OUTPS=0000 ... 1:1
+    T2HLT = 0x00;       // PSYNC=0, CPOL=0, CSYNC=0, MODE=00000 (Free Running Period)
+    T2CLKCON = 0x05;    // (0), (0), (0), (0), CS=0101 ... MFINTOSC(500kHz)
+    T2PR = 12;          // 500kHz / 13 = 38.5kHz
+    PWM6DCH = 4;        // DC=17 ... 17 / (4 * 13) = 1/3
+    PWM6DCL = 0x40;
+    PWM6CON = 0x80;     // EN=1, (0), OUT=0, POL=0, (0), (0), (0), (0)
+    T2CONbits.ON = 1;
+
+    // 変調
+    CLC1CON = 0x00;
+    CLC1SEL0 = IRT_CLCSEL_PWM6;
+    CLC1SEL1 = 0x00;
+    CLC1SEL2 = 0x00;
+    CLC1SEL3 = 0x00;
+    CLC1GLS0 = 0x02;    // G1: D1T
+    CLC1GLS1 = 0x00;    // G2〜G4: 入力なし(G2POL〜G4POLがそのまま出力される)
+    CLC1GLS2 = 0x00;
+    CLC1GLS3 = 0x00;
+    CLC1POL = IRT_CLCPOL_SPACE;
+    CLC1CON = 0x82;     // EN=1, (0), OUT=0, INTP=0, INTN=0, MODE=010 (4-input AND)
+
+    // 時間
+    T6CON = 0x30;       // ON=0, CKPS=011 ... 1:8, OUTPS=0000 ... 1:1
+    T6HLT = 0x00;       // PSYNC=0, CPOL=0, CSYNC=0, MODE=00000 (Free Running Period)
+    T6CLKCON = 0x05;    // (0), (0), (0), (0), CS=0101 ... MFINTOSC(500kHz)
+
+    PIR4bits.TMR6IF = 0;
+    PIE4bits.TMR6IE = 1;
+}
+
+#else
+
+char ir_transmitter_send(irr_type_t type, const char *data, char length)
+{
+    return 0;
+}
+
+char ir_transmitter_busy(void)
+{
+    return 0;
+}
+
+void ir_transmitter_init(void)
+{
+}
+
+#endif  // IRT_ENABLE
@@ -0,0 +1,39 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_IR_TRANSMITTER_H_
+#define _IR_REMOCON_ANALYZER_IR_TRANSMITTER_H_
+
+#include "ir_protocol.h"
+
+#define IRT_ENABLE                  // 赤外線送信(RC4: CLC1OUT)
+//#define IRT_RELAY                 // キーコードに割り当てのないフレームを中継する
+
+#define IRT_DATA_MAX        16      // 送信する最大データ長
+
+char ir_transmitter_send(irr_type_t type, const char *data, char length);
+char ir_transmitter_busy(void);
+void ir_transmitter_init(void);
+
+#endif // _IR_REMOCON_ANALYZER_IR_TRANSMITTER_H_
@@ -25,9 +25,17 @@
 #include "common.h"
 #include "main.h"
 #include "buzzer.h"
+#include "clock.h"
+#include "debug_pin.h"
 #include "interrupts.h"
 #include "ir_receiver.h"
+#include "ir_transmitter.h"
 #include "pins.h"
+#include "power_stats.h"
+#include "power_timer.h"
+#include "settings.h"
+#include "trace.h"
+#include "uart.h"
 
 #include <pic.h>
 
@@ -56,10 +64,10 @@
 
 //CONFIG4
 #pragma config BBSIZE = BB512
-#pragma config BBEN = OFF
+#pragma config BBEN = ON        // 0x000〜0x1FFはブートローダー(bootloader/)。bootloader.cと同じ値にすること
 #pragma config SAFEN = OFF
 #pragma config WRTAPP = OFF
-#pragma config WRTB = OFF
+#pragma config WRTB = ON
 #pragma config WRTC = OFF
 #pragma config WRTD = OFF
 #pragma config WRTSAF = OFF
@@ -68,125 +76,183 @@
 //CONFIG5
 #pragma config CP = OFF
 
-typedef enum {
-    CMD_NONE = 0,
-    CMD_OFF,
-    CMD_ON,
-    CMD_LONGPUSH,
-} pcremocon_cmd_t;
-
 volatile irr_common_data_t irr_common_data = {
     .received = 0,
-    .keycode = KEYCODE_NONE
+    .keycode = KEYCODE_NONE,
+    .command = CMD_NONE
 };
 
 void init()
 {
     pins_init();
+    debug_pin_init();
 
+    settings_init();
+    trace_init();
     buzzer_init();
     ir_receiver_init();
+    ir_transmitter_init();
+    uart_init();
+    clock_init();
+    power_timer_init();
+    power_stats_init();
 
     interrupts_init();
 }
 
-int main()
+// メインループの1回分(ホストシミュレーターからも呼ぶ)
+void main_task(void)
 {
     pcremocon_cmd_t cmd;
     int i;
+#ifdef POWER_TIMER_ENABLE
+    signed char timer_steps = -1;   // 予約の残りの単位数(予約の操作でない場合は-1)
+#endif
 
-    init();
+    uart_poll();
+    power_stats_poll();
 
-    while(1)
+    if( COMMON.received != 0 )
     {
-        // PWM使用時はSLEEPは使用不可(発振が止まる)
-        //SLEEP();
+        DEBUG_ENTER(DEBUG_SRC_MAIN);
+        // __delay_msを使うので高速のクロックで実行する
+        di();
+        clock_hold();
+        ei();
+        LED1 = 1;
+        TRACE_MAIN(TRACE_KIND_PWR_LED | PC_POWER_LED_N, 0);
 
-        if( COMMON.received != 0 )
+        // 動作判定
+        cmd = CMD_NONE;
+        if( COMMON.keycode == KEYCODE_OFF || COMMON.command == CMD_OFF )
         {
-            LED1 = 1;
-
-            // 動作判定
-            cmd = CMD_NONE;
-            if( COMMON.keycode == KEYCODE_OFF )
-            {
-                //buzzer_on(BZR_FREQ2CNT(523));
-                if( PC_POWER_LED_N == 0 )
-                {
-                    cmd = CMD_OFF;
-                }
-            }
-            else if ( COMMON.keycode == KEYCODE_FAVORITE )
-            {
-                //buzzer_on(BZR_FREQ2CNT(587));
-            }
-            else if ( COMMON.keycode == KEYCODE_NIGHTLIGHT )
-            {
-                //buzzer_on(BZR_FREQ2CNT(659));
-                cmd = CMD_LONGPUSH;
-            }
-            else if ( COMMON.keycode == KEYCODE_MINUS )
-            {
-                //buzzer_on(BZR_FREQ2CNT(698));
-            }
-            else if ( COMMON.keycode == KEYCODE_PLUS )
+            //buzzer_on(BZR_FREQ2CNT(523));
+            if( PC_POWER_LED_N == 0 )
             {
-                //buzzer_on(BZR_FREQ2CNT(783));
+                cmd = CMD_OFF;
             }
-            else if ( COMMON.keycode == KEYCODE_ALL )
+        }
+        else if ( COMMON.keycode == KEYCODE_FAVORITE )
+        {
+            //buzzer_on(BZR_FREQ2CNT(587));
+#ifdef POWER_TIMER_ENABLE
+            // 予約の取り消し
+            power_timer_cancel();
+            timer_steps = 0;
+#endif
+        }
+        else if ( COMMON.keycode == KEYCODE_NIGHTLIGHT || COMMON.command == CMD_LONGPUSH )
+        {
+            //buzzer_on(BZR_FREQ2CNT(659));
+            cmd = CMD_LONGPUSH;
+        }
+        else if ( COMMON.keycode == KEYCODE_MINUS )
+        {
+            //buzzer_on(BZR_FREQ2CNT(698));
+#ifdef POWER_TIMER_ENABLE
+            timer_steps = power_timer_adjust(-1, PC_POWER_LED_N == 0 ? CMD_OFF : CMD_ON);
+#endif
+        }
+        else if ( COMMON.keycode == KEYCODE_PLUS )
+        {
+            //buzzer_on(BZR_FREQ2CNT(783));
+#ifdef POWER_TIMER_ENABLE
+            // PCがオンなら電源オフ、オフなら電源オンを予約する
+            timer_steps = power_timer_adjust(1, PC_POWER_LED_N == 0 ? CMD_OFF : CMD_ON);
+#endif
+        }
+        else if ( COMMON.keycode == KEYCODE_ALL || COMMON.command == CMD_ON )
+        {
+            //buzzer_on(BZR_FREQ2CNT(880));
+            if( PC_POWER_LED_N != 0 )
             {
-                //buzzer_on(BZR_FREQ2CNT(880));
-                if( PC_POWER_LED_N != 0 )
-                {
-                    cmd = CMD_ON;
-                }
+                cmd = CMD_ON;
             }
+        }
+
+        TRACE_MAIN(TRACE_KIND_CMD | cmd, COMMON.keycode);
+        if( cmd != CMD_NONE )
+            power_stats_start(cmd);     // 電源LEDが変化するまでの時間を計る
 
-            // 動作実行
-            if( cmd == CMD_OFF )
+        // 動作実行
+        if( cmd == CMD_OFF )
+        {
+            PC_POWER_SW = 1;
+            buzzer_on(SETTINGS.beep_hi);
+            c_delay_10ms(SETTINGS.beep_off_time);
+            buzzer_off();
+            __delay_ms(100);
+            PC_POWER_SW = 0;
+        }
+        else if( cmd == CMD_ON )
+        {
+            PC_POWER_SW = 1;
+            buzzer_on(SETTINGS.beep_hi);
+            c_delay_10ms(SETTINGS.beep_on_time);
+            buzzer_on(SETTINGS.beep_lo);
+            c_delay_10ms(SETTINGS.beep_on_time);
+            buzzer_off();
+            __delay_ms(100);
+            PC_POWER_SW = 0;
+        }
+        else if( cmd == CMD_LONGPUSH )
+        {
+            PC_POWER_SW = 1;
+            for( i=0; i<SETTINGS.longpush_time/2; i++ )
             {
-                PC_POWER_SW = 1;
-                buzzer_on(BZR_FREQ2CNT(2000));
-                __delay_ms(400);
-                buzzer_off();
+                LED1 = 1;
+                buzzer_on(SETTINGS.beep_hi);
                 __delay_ms(100);
-                PC_POWER_SW = 0;
-            }
-            else if( cmd == CMD_ON )
-            {
-                PC_POWER_SW = 1;
-                buzzer_on(BZR_FREQ2CNT(2000));
-                __delay_ms(200);
-                buzzer_on(BZR_FREQ2CNT(1000));
-                __delay_ms(200);
+                LED1 = 0;
                 buzzer_off();
                 __delay_ms(100);
-                PC_POWER_SW = 0;
             }
-            else if( cmd == CMD_LONGPUSH )
+            buzzer_off();
+            PC_POWER_SW = 0;
+        }
+#ifdef POWER_TIMER_ENABLE
+        else if( timer_steps > 0 )
+        {
+            // 残りの単位数だけ鳴らす(電源オフの予約は高音、電源オンの予約は低音)
+            for( i=0; i<timer_steps; i++ )
             {
-                PC_POWER_SW = 1;
-                for( i=0; i<120/2; i++ )
-                {
-                    LED1 = 1;
-                    buzzer_on(BZR_FREQ2CNT(2000));
-                    __delay_ms(100);
-                    LED1 = 0;
-                    buzzer_off();
-                    __delay_ms(100);
-                }
+                buzzer_on(power_timer_command() == CMD_OFF ? SETTINGS.beep_hi : SETTINGS.beep_lo);
+                __delay_ms(100);
                 buzzer_off();
-                PC_POWER_SW = 0;
-            }
-            else
-            {
-                buzzer_on(BZR_FREQ2CNT(1000));
                 __delay_ms(100);
-                buzzer_off();        
             }
-            LED1 = 0;
-            COMMON.received = 0;
         }
+#endif
+        else
+        {
+            buzzer_on(SETTINGS.beep_lo);
+            c_delay_10ms(SETTINGS.beep_ack_time);
+            buzzer_off();        
+        }
+        LED1 = 0;
+        TRACE_MAIN(TRACE_KIND_PWR_LED | PC_POWER_LED_N, 0);
+        COMMON.command = CMD_NONE;
+        COMMON.received = 0;
+        di();
+        clock_release();
+        ei();
+        DEBUG_EXIT(DEBUG_SRC_MAIN);
+    }
+}
+
+int main()
+{
+    init();
+
+    while(1)
+    {
+        main_task();
+
+        // PWM使用時はSLEEPは使用不可(発振が止まる)のでIDLEで待つ
+        di();
+        if( COMMON.received == 0 && uart_pending() == 0 )
+            clock_wait();
+        ei();
     }
     return 0;
 };
@@ -33,11 +33,20 @@ typedef enum {
     KEYCODE_MINUS,
     KEYCODE_PLUS,
     KEYCODE_ALL,
+    KEYCODE_MAX,
 } keycode_t;
 
+typedef enum {
+    CMD_NONE = 0,
+    CMD_OFF,
+    CMD_ON,
+    CMD_LONGPUSH,
+} pcremocon_cmd_t;
+
 typedef struct {
-    char        received;
-    keycode_t   keycode;
+    char            received;
+    keycode_t       keycode;
+    pcremocon_cmd_t command;    // UARTからの動作要求
 } irr_common_data_t;
 extern volatile irr_common_data_t irr_common_data;
 #define COMMON irr_common_data
@@ -24,6 +24,8 @@
 
 #include "common.h"
 #include "pins.h"
+#include "ir_transmitter.h"
+#include "uart.h"
 
 void pins_init(void)
 {
@@ -52,4 +54,25 @@ void pins_init(void)
     TRISCbits.TRISC5 = 1;
     SMT1SIGPPS = 0x15;  // RC5
     // 正論理の場合はSMT1CON0のSPOLビットを0にする
+
+#ifdef IRT_ENABLE
+    // RC4: IR LED (OUT)
+    ANSELCbits.ANSC4 = 0;
+    LATCbits.LATC4 = 0;
+    TRISCbits.TRISC4 = 0;
+    RC4PPS = 0x01;      // CLC1OUT
+#endif
+
+#ifdef UART_ENABLE
+    // RA4: UART TX (OUT)
+    ANSELAbits.ANSA4 = 0;
+    LATAbits.LATA4 = 1;
+    TRISAbits.TRISA4 = 0;
+    RA4PPS = 0x0F;      // TX1/CK1
+
+    // RC2: UART RX (IN)
+    ANSELCbits.ANSC2 = 0;
+    TRISCbits.TRISC2 = 1;
+    RX1DTPPS = 0x12;    // RC2
+#endif
 }
@@ -0,0 +1,213 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "main.h"
+#include "debug_pin.h"
+#include "hef.h"
+#include "power_stats.h"
+
+#ifdef POWER_STATS_ENABLE
+
+// PCの電源スイッチを押した時刻と、その後に電源LED(RC0)が最初に変化した時刻をTimer1で計り、
+// 動作ごとに対数のバケットで数える。電源の入りや切れが遅くなっていれば、電源ユニットの劣化や
+// OSのシャットダウンの停止を疑える
+//
+// HEFの最後の行に保存する
+// HEFは下位8bitのみ高耐久なので、ヘッダーも含めて1ワードに1バイトずつ書く(hef_write_bytes)
+//   先頭2ワード: ヘッダー (タグ, バージョン)
+//   以降のワード: 各動作・各バケットの回数
+#define POWER_STATS_ROW_ADDR    (HEF_ADDR + HEF_STATS_ROW * HEF_ROW_SIZE)
+#define POWER_STATS_TAG         0xB5
+#define POWER_STATS_HEADER_LEN  2
+#define POWER_STATS_NONE        (POWER_STATS_BUCKETS - 1)   // 変化なしのバケット
+
+typedef enum {
+    POWER_STATS_IDLE = 0,
+    POWER_STATS_WAIT,           // 電源LEDの変化待ち
+    POWER_STATS_DONE,           // 変化した(メインループで集計する)
+} power_stats_state_t;
+
+typedef struct {
+    unsigned char   hist[POWER_STATS_ACTIONS][POWER_STATS_BUCKETS];
+    unsigned char   state;      // power_stats_state_t
+    unsigned char   action;     // 計測中の動作(cmd - CMD_OFF)
+    unsigned char   dirty;      // 保存していない変化がある
+    unsigned long   start;      // 電源スイッチを押した時刻
+    unsigned long   end;        // 電源LEDが変化した時刻
+    unsigned long   saved;      // 最後に保存(または起動)した時刻
+} power_stats_data_t;
+
+// 1行に全バケットが収まること
+typedef char power_stats_size_check_t[(POWER_STATS_ACTIONS * POWER_STATS_BUCKETS <= HEF_ROW_SIZE - POWER_STATS_HEADER_LEN) ? 1 : -1];
+
+power_stats_data_t power_stats_data;
+#define PS      power_stats_data
+
+// 0.5秒未満から1秒、2秒...と倍になるバケット
+static unsigned char power_stats_bucket(unsigned long ticks)
+{
+    unsigned long limit = power_timer_rate() / 2;
+    unsigned char bucket;
+
+    for( bucket = 0; bucket < POWER_STATS_NONE - 1; bucket++ )
+    {
+        if( ticks < limit )
+            break;
+        limit <<= 1;
+    }
+    return bucket;
+}
+
+static void power_stats_add(unsigned char bucket)
+{
+    unsigned char *hist = PS.hist[PS.action];
+    unsigned char i;
+
+    // 飽和したら全体を半分にして比率を保つ
+    // UARTの受信割り込みがpower_stats_getで読むので、途中の状態を見せない
+    di();
+    if( hist[bucket] == 0xFF )
+    {
+        for( i = 0; i < POWER_STATS_BUCKETS; i++ )
+            hist[i] >>= 1;
+    }
+    hist[bucket]++;
+    ei();
+    PS.dirty = 1;
+}
+
+// ヘッダーを最後に書くので、途中で電源が切れた場合は次の起動時に空として扱う
+static void power_stats_save(void)
+{
+    static const unsigned char header[POWER_STATS_HEADER_LEN] = { POWER_STATS_TAG, POWER_STATS_VERSION };
+
+    hef_erase_row(POWER_STATS_ROW_ADDR);
+    hef_write_bytes(POWER_STATS_ROW_ADDR + POWER_STATS_HEADER_LEN, &PS.hist[0][0], sizeof(PS.hist));
+    hef_write_bytes(POWER_STATS_ROW_ADDR, header, POWER_STATS_HEADER_LEN);
+    PS.dirty = 0;
+}
+
+void power_stats_start(pcremocon_cmd_t cmd)
+{
+    di();
+    IOCCFbits.IOCCF0 = 0;
+    PS.action = cmd - CMD_OFF;
+    PS.start = power_timer_now();
+    PS.state = POWER_STATS_WAIT;
+    ei();
+}
+
+// 割り込みでIDLEから戻ったとき(Timer1のオーバーフローは約2.1秒ごと)に呼ばれる
+void power_stats_poll(void)
+{
+    unsigned long now;
+    unsigned char state;
+
+    di();
+    now = power_timer_now();
+    state = PS.state;
+    ei();
+
+    if( state == POWER_STATS_DONE )
+    {
+        power_stats_add(power_stats_bucket(PS.end - PS.start));
+        PS.state = POWER_STATS_IDLE;
+    }
+    else if( state == POWER_STATS_WAIT
+             && now - PS.start >= (unsigned long)POWER_STATS_TIMEOUT_S * power_timer_rate() )
+    {
+        // 判定の直後に変化した場合は、変化した方を集計する
+        di();
+        state = PS.state;
+        if( state == POWER_STATS_WAIT )
+            PS.state = POWER_STATS_IDLE;
+        ei();
+        if( state == POWER_STATS_WAIT )
+            power_stats_add(POWER_STATS_NONE);
+    }
+
+    // フラッシュの書き込み中はCPUが止まるので、頻繁には保存しない
+    if( PS.dirty != 0 && now - PS.saved >= (unsigned long)POWER_STATS_SAVE_H * 3600 * power_timer_rate() )
+    {
+        power_stats_save();
+        PS.saved = now;
+    }
+}
+
+const unsigned char *power_stats_get(pcremocon_cmd_t cmd)
+{
+    return PS.hist[cmd - CMD_OFF];
+}
+
+void __interrupt(__flags(PEIE, IOCIE, IOCIF, 18))
+    power_stats_ioc_isr(void)
+{
+    DEBUG_ENTER(DEBUG_SRC_LED);
+    IOCCFbits.IOCCF0 = 0;
+    if( PS.state == POWER_STATS_WAIT )
+    {
+        PS.end = power_timer_now();
+        PS.state = POWER_STATS_DONE;
+    }
+    DEBUG_EXIT(DEBUG_SRC_LED);
+}
+
+// power_timer_init(Timer1の開始)より後に呼ぶ
+void power_stats_init(void)
+{
+    unsigned char i;
+    unsigned char *hist = &PS.hist[0][0];
+
+    c_memzero(&PS, sizeof(PS));
+
+    if( (hef_read(POWER_STATS_ROW_ADDR) & 0xFF) == POWER_STATS_TAG
+        && (hef_read(POWER_STATS_ROW_ADDR + 1) & 0xFF) == POWER_STATS_VERSION )
+    {
+        for( i = 0; i < sizeof(PS.hist); i++ )
+            hist[i] = hef_read(POWER_STATS_ROW_ADDR + POWER_STATS_HEADER_LEN + i) & 0xFF;
+    }
+
+    // RC0: 電源LEDの両方のエッジで割り込み
+    IOCCPbits.IOCCP0 = 1;
+    IOCCNbits.IOCCN0 = 1;
+    IOCCFbits.IOCCF0 = 0;
+    PIE0bits.IOCIE = 1;
+}
+
+#else
+
+void power_stats_start(pcremocon_cmd_t cmd)
+{
+}
+
+void power_stats_poll(void)
+{
+}
+
+void power_stats_init(void)
+{
+}
+
+#endif  // POWER_STATS_ENABLE
@@ -0,0 +1,49 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_POWER_STATS_H_
+#define _IR_REMOCON_ANALYZER_POWER_STATS_H_
+
+#include "main.h"
+#include "power_timer.h"
+
+#define POWER_STATS_ENABLE              // 電源操作から電源LEDが変化するまでの時間を記録する(HEFに保存)
+
+#define POWER_STATS_VERSION     1       // 保存する形式を変えたら更新する(0〜15)
+#define POWER_STATS_ACTIONS     (CMD_LONGPUSH - CMD_OFF + 1)    // CMD_OFF, CMD_ON, CMD_LONGPUSH
+#define POWER_STATS_BUCKETS     10      // 0.5秒未満, 1秒未満, 2, 4, 8, 16, 32, 64秒未満, 64秒以上, 変化なし
+#define POWER_STATS_TIMEOUT_S   300     // これを過ぎても変化しなければ「変化なし」に数える(秒)
+#define POWER_STATS_SAVE_H      6       // 変化があればこの間隔でHEFに保存する(時間)
+
+#if defined(POWER_STATS_ENABLE) && !defined(POWER_TIMER_ENABLE)
+#error "POWER_STATS_ENABLEにはPOWER_TIMER_ENABLE(Timer1の時刻)が必要です"
+#endif
+
+// いずれもメインループから呼ぶ(power_stats_getは割り込み処理内からも可)
+void power_stats_start(pcremocon_cmd_t cmd);    // PCの電源スイッチを押す直前に呼ぶ
+void power_stats_poll(void);                    // 計測結果の集計と定期的な保存
+const unsigned char *power_stats_get(pcremocon_cmd_t cmd);  // POWER_STATS_BUCKETS個の回数(飽和すると全体を半分にする)
+void power_stats_init(void);
+
+#endif // _IR_REMOCON_ANALYZER_POWER_STATS_H_
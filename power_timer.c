@@ -0,0 +1,243 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "main.h"
+#include "debug_pin.h"
+#include "settings.h"
+#include "power_timer.h"
+
+#ifdef POWER_TIMER_ENABLE
+
+#define POWER_TIMER_CAL_COUNT   ((unsigned int)(500000UL * POWER_TIMER_CAL_MS / 1000))  // MFINTOSC(500kHz)のカウント数
+
+// Timer1はLFINTOSCで非同期に動作するので、SLEEP/IDLE中もシステムクロックの切り替え中も止まらない。
+// 16bitのオーバーフロー(約2.1秒)ごとに割り込みで残り回数を減らし、0になったら動作を要求する
+typedef struct {
+    pcremocon_cmd_t cmd;        // 予約した動作(CMD_NONE=予約なし)
+    unsigned long   remain;     // 残りのオーバーフロー回数
+    unsigned int    rate;       // 校正したLFINTOSCの周波数(Hz)
+    unsigned int    overflows;  // 通算のオーバーフロー回数(時刻の上位16bit)
+    unsigned int    cal_start;  // 校正を始めたときのTMR1
+} power_timer_data_t;
+
+power_timer_data_t power_timer_data;
+#define PT      power_timer_data
+
+// 非同期のTMR1は読み出し中に桁上がりすることがあるので、2回続けて同じ値になるまで読む
+static unsigned int power_timer_read(void)
+{
+    unsigned int a, b;
+
+    do {
+        a = TMR1L;                  // TMR1Lの読み出しでTMR1Hがラッチされる(RD16=1)
+        a |= (unsigned int)TMR1H << 8;
+        b = TMR1L;
+        b |= (unsigned int)TMR1H << 8;
+    } while( a != b );
+    return a;
+}
+
+// LFINTOSCは個体差・温度の誤差が大きいので、MFINTOSC(HFINTOSCから分周)で動作するTimer0で
+// POWER_TIMER_CAL_MSを測り、その間のTMR1のカウントから周波数を求める。
+// 終わりはTimer0の割り込み(power_timer_cal_isr)で読むので、測定中も割り込みは止めない。結果は次の予約から使う
+static void power_timer_calibrate(void)
+{
+    char gie = INTCONbits.GIE;
+    unsigned int start;
+
+    if( T0CON0bits.T0EN != 0 )
+        return;     // 測定中
+
+    TMR0H = (65536UL - POWER_TIMER_CAL_COUNT) >> 8;     // TMR0Lの書き込みで反映される(T0MD16=1)
+    TMR0L = (65536UL - POWER_TIMER_CAL_COUNT) & 0xFF;
+    PIR0bits.TMR0IF = 0;
+
+    di();
+    start = power_timer_read();
+    while( power_timer_read() == start );   // LFINTOSCのエッジに合わせる(約32us)
+    PT.cal_start = power_timer_read();
+    T0CON0bits.T0EN = 1;
+    if( gie )
+        ei();
+}
+
+// 1単位(settings.timer_step分)のオーバーフロー回数
+static unsigned long power_timer_step(void)
+{
+    unsigned long step;
+
+    step = ((unsigned long)SETTINGS.timer_step * 60 * power_timer_rate() + 0x8000) >> 16;
+    return step != 0 ? step : 1;
+}
+
+// 予約を単位数だけ増減する。予約がない場合はcmdの動作で新しく予約する
+unsigned char power_timer_adjust(signed char steps, pcremocon_cmd_t cmd)
+{
+    unsigned long step;
+    unsigned long remain;
+
+    step = power_timer_step();
+    power_timer_calibrate();    // 温度の変化に追従するため、押すたびに測り直す
+
+    di();
+    remain = PT.remain;
+    if( PT.cmd == CMD_NONE )
+    {
+        PT.cmd = cmd;
+        remain = 0;
+    }
+    if( steps > 0 )
+    {
+        remain += step * steps;
+        if( remain > step * POWER_TIMER_STEPS_MAX )
+            remain = step * POWER_TIMER_STEPS_MAX;
+    }
+    else if( remain > step * -steps )
+    {
+        remain -= step * -steps;
+    }
+    else
+    {
+        remain = 0;
+    }
+    PT.remain = remain;
+    if( remain == 0 )
+        PT.cmd = CMD_NONE;
+    ei();
+
+    return (unsigned char)((remain + step - 1) / step);
+}
+
+void power_timer_cancel(void)
+{
+    di();
+    PT.remain = 0;
+    PT.cmd = CMD_NONE;
+    ei();
+}
+
+pcremocon_cmd_t power_timer_command(void)
+{
+    return PT.cmd;
+}
+
+unsigned long power_timer_now(void)
+{
+    unsigned int count = power_timer_read();
+    unsigned int overflows = PT.overflows;
+
+    // 読み出しの前にオーバーフローして、まだ割り込み処理していない場合
+    if( PIR4bits.TMR1IF != 0 && count < 0x8000 )
+        overflows++;
+    return ((unsigned long)overflows << 16) | count;
+}
+
+// トレースのタイムスタンプ(時刻の1/32の下位16bit)。SMTの割り込み処理内から呼ぶので、
+// power_timer_now()の二重読み出し・オーバーフローの補正・32bitのシフトは省く。
+// TMR1の折り返しの直後(TMR1の割り込みが未処理の間)は約2.1秒戻って見えることがある
+unsigned int power_timer_trace_time(void)
+{
+    unsigned char low = TMR1L;      // TMR1Lの読み出しでTMR1Hがラッチされる(RD16=1)
+    unsigned char high = TMR1H;
+
+    low = (unsigned char)(high << 3) | (low >> 5);
+    high = (unsigned char)(PT.overflows << 3) | (high >> 5);
+    return ((unsigned int)high << 8) | low;
+}
+
+unsigned int power_timer_rate(void)
+{
+    unsigned int rate;
+
+    di();                       // power_timer_cal_isrが書き換える
+    rate = PT.rate;
+    ei();
+    return rate;
+}
+
+void __interrupt(__flags(PEIE, TMR1IE, TMR1IF, 17))
+    power_timer_isr(void)
+{
+    DEBUG_ENTER(DEBUG_SRC_TIMER);
+    TMR1IF = 0;
+    PT.overflows++;
+    if( PT.remain != 0 && --PT.remain == 0 )
+    {
+        if( COMMON.received == 0 )
+        {
+            // UARTのPOWERと同じく、電源LEDの確認はメインループで行う
+            COMMON.keycode = KEYCODE_NONE;
+            COMMON.command = PT.cmd;
+            COMMON.received = 1;
+            PT.cmd = CMD_NONE;
+        }
+        else
+        {
+            // メインループの動作中は次のオーバーフローで再度要求する
+            PT.remain = 1;
+        }
+    }
+    DEBUG_EXIT(DEBUG_SRC_TIMER);
+}
+
+void __interrupt(__flags(PEIE, TMR0IE, TMR0IF, 19))
+    power_timer_cal_isr(void)
+{
+    DEBUG_ENTER(DEBUG_SRC_TIMER);
+    TMR0IF = 0;
+    T0CON0bits.T0EN = 0;
+    // TMR1の折り返しを考慮する(ホストのシミュレーターはintが32bit)
+    PT.rate = ((power_timer_read() - PT.cal_start) & 0xFFFF) * (1000 / POWER_TIMER_CAL_MS);
+    DEBUG_EXIT(DEBUG_SRC_TIMER);
+}
+
+void power_timer_init(void)
+{
+    c_memzero(&PT, sizeof(PT));
+    PT.rate = POWER_TIMER_LFINTOSC;
+
+    T1CON = 0x06;       // (0), (0), CKPS=00 ... 1:1, (0), SYNC=1 ... 非同期, RD16=1, ON=0
+    T1GCON = 0x00;      // GE=0 ... ゲートなし
+    T1CLK = 0x04;       // (0), (0), (0), (0), CS=0100 ... LFINTOSC
+    TMR1H = 0x00;
+    TMR1L = 0x00;
+
+    PIR4bits.TMR1IF = 0;
+    PIE4bits.TMR1IE = 1;
+    T1CONbits.ON = 1;
+
+    T0CON1 = 0xB0;      // T0CS=101 ... MFINTOSC(500kHz), T0ASYNC=1, T0CKPS=0000 ... 1:1
+    T0CON0 = 0x10;      // T0EN=0, (0), (0), T0MD16=1, T0OUTPS=0000 ... 1:1
+    PIE0bits.TMR0IE = 1;
+    power_timer_calibrate();
+}
+
+#else
+
+void power_timer_init(void)
+{
+}
+
+#endif  // POWER_TIMER_ENABLE
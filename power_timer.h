@@ -0,0 +1,47 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_POWER_TIMER_H_
+#define _IR_REMOCON_ANALYZER_POWER_TIMER_H_
+
+#include "main.h"
+
+#define POWER_TIMER_ENABLE              // +/-キーで電源オフ(PCがオンの場合)・オン(オフの場合)を予約する
+
+#define POWER_TIMER_STEPS_MAX   16      // 予約できる最大の単位数(1単位はsettings.timer_step分)
+#define POWER_TIMER_LFINTOSC    31000   // LFINTOSCの公称周波数(Hz)。校正するまではこの値を使う
+#define POWER_TIMER_CAL_MS      100     // 校正でLFINTOSCを数える時間(Timer0の割り込みで終了する)
+
+// いずれもメインループから呼ぶ
+unsigned char power_timer_adjust(signed char steps, pcremocon_cmd_t cmd);   // 戻り値は残りの単位数(切り上げ)
+void power_timer_cancel(void);
+pcremocon_cmd_t power_timer_command(void);      // 予約中の動作(CMD_NONE=予約なし)
+void power_timer_init(void);
+
+// 時刻(Timer1の通算カウント, 約38時間で一周)。割り込み禁止の状態(割り込み処理内を含む)で呼ぶこと
+unsigned long power_timer_now(void);
+unsigned int power_timer_trace_time(void);      // トレースのタイムスタンプ(LFINTOSC / 32)。割り込み処理内から呼ぶ
+unsigned int power_timer_rate(void);            // 校正したLFINTOSCの周波数(Hz)。メインループから呼ぶ
+
+#endif // _IR_REMOCON_ANALYZER_POWER_TIMER_H_
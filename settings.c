@@ -0,0 +1,195 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "settings.h"
+#include "buzzer.h"
+#include "hef.h"
+
+// HEFの先頭のHEF_SETTINGS_ROWS行を追記型のログとして使う
+// HEFは下位8bitのみ高耐久なので、各ワードには1バイトだけ書く(hef_write_bytes)
+//   先頭2ワード: ヘッダー (タグ(上位4bit)・バージョン(下位4bit), シーケンス番号)
+//   以降の2ワード: レコード (オフセット, 値)。オフセットが0xFF(消去状態)なら未使用
+//   コンパクションはデフォルト値と異なる範囲を1つの連続レコード
+//   (オフセット | SETTINGS_RUN, 個数, 値 × 個数) にまとめて書く
+// 最もシーケンス番号が新しい行が有効。行が埋まったら次の行を消去し、
+// デフォルト値と異なる範囲だけを書き直す(コンパクション)。行を順番に使うことで消耗を分散する
+#define SETTINGS_ROWS       HEF_SETTINGS_ROWS
+#define SETTINGS_ROW_ADDR(R) (HEF_ADDR + (unsigned int)(R) * HEF_ROW_SIZE)
+#define SETTINGS_TAG        (0xA0 | SETTINGS_VERSION)
+#define SETTINGS_HEADER_LEN 2
+#define SETTINGS_RECORD_LEN 2
+#define SETTINGS_RUN        0x80
+#define SETTINGS_NO_ROW     0xFF
+
+// 1行に全項目の連続レコードが収まること
+typedef char settings_size_check_t[(sizeof(settings_t) <= HEF_ROW_SIZE - SETTINGS_HEADER_LEN - SETTINGS_RECORD_LEN) ? 1 : -1];
+
+const settings_t settings_default = {
+    // Nature Remo Preset: NEC LIGHT 201
+    .key_custom = { 0x82, 0x6d },
+    .key_data = {
+        [KEYCODE_OFF - KEYCODE_OFF]         = 0xbe,
+        [KEYCODE_FAVORITE - KEYCODE_OFF]    = 0xbd,
+        [KEYCODE_NIGHTLIGHT - KEYCODE_OFF]  = 0xbc,
+        [KEYCODE_MINUS - KEYCODE_OFF]       = 0xbb,
+        [KEYCODE_PLUS - KEYCODE_OFF]        = 0xba,
+        [KEYCODE_ALL - KEYCODE_OFF]         = 0xa6,
+    },
+    .longpush_time = 120,
+    .leader_coeff_min = 90,
+    .leader_coeff_max = 110,
+    .beep_hi = BZR_FREQ2CNT(2000),
+    .beep_lo = BZR_FREQ2CNT(1000),
+    .beep_off_time = 40,
+    .beep_on_time = 20,
+    .beep_ack_time = 10,
+    // 誤動作すると困る電源オフと長押し(常夜灯)は2フレームで確定する
+    .key_confirm = {
+        SETTINGS_CONFIRM(2, 1),     // OFF, お気に入り
+        SETTINGS_CONFIRM(2, 1),     // 常夜灯, -
+        SETTINGS_CONFIRM(1, 1),     // +, 全灯
+    },
+    .timer_step = 30,
+};
+
+settings_t settings;
+
+static unsigned char settings_row;      // 有効な行
+static unsigned char settings_seq;      // 有効な行のシーケンス番号
+static unsigned char settings_next;     // 次にレコードを書く位置(行内のワード位置)
+
+void settings_init(void)
+{
+    unsigned char row;
+    unsigned char seq;
+    unsigned char offset;
+    unsigned char count;
+    unsigned int addr;
+    unsigned char *image = (unsigned char *)&settings;
+
+    c_memcopy(&settings, &settings_default, sizeof(settings));
+
+    // 有効な行を探す
+    settings_row = SETTINGS_NO_ROW;
+    for( row = 0; row < SETTINGS_ROWS; row++ )
+    {
+        if( (hef_read(SETTINGS_ROW_ADDR(row)) & 0xFF) != SETTINGS_TAG )
+            continue;
+        seq = hef_read(SETTINGS_ROW_ADDR(row) + 1) & 0xFF;
+        if( settings_row == SETTINGS_NO_ROW || (signed char)(seq - settings_seq) > 0 )
+        {
+            settings_row = row;
+            settings_seq = seq;
+        }
+    }
+    if( settings_row == SETTINGS_NO_ROW )
+        return;
+
+    // レコードを先頭から順に反映する(後のレコードが優先)
+    addr = SETTINGS_ROW_ADDR(settings_row);
+    settings_next = SETTINGS_HEADER_LEN;
+    while( settings_next + SETTINGS_RECORD_LEN <= HEF_ROW_SIZE )
+    {
+        offset = hef_read(addr + settings_next) & 0xFF;
+        if( offset == 0xFF )
+            return;
+        count = hef_read(addr + settings_next + 1) & 0xFF;
+        if( (offset & SETTINGS_RUN) == 0 )
+        {
+            if( offset < sizeof(settings) )
+                image[offset] = count;
+            settings_next += SETTINGS_RECORD_LEN;
+            continue;
+        }
+
+        offset &= ~SETTINGS_RUN;
+        if( offset + count > sizeof(settings) || settings_next + SETTINGS_RECORD_LEN + count > HEF_ROW_SIZE )
+            break;
+        for( settings_next += SETTINGS_RECORD_LEN; count > 0; count--, offset++, settings_next++ )
+            image[offset] = hef_read(addr + settings_next) & 0xFF;
+    }
+    // 壊れたレコードの後ろには追記しない(次の書き込みでコンパクションする)
+    settings_next = HEF_ROW_SIZE;
+}
+
+// 次の行にデフォルト値と異なる範囲だけを書き直す
+// ヘッダーを最後に書くので、途中で電源が切れても元の行が有効なまま残る
+static void settings_compact(void)
+{
+    unsigned char record[SETTINGS_RECORD_LEN];
+    unsigned char first;
+    unsigned char last;
+    unsigned char row;
+    const unsigned char *image = (const unsigned char *)&settings;
+    const unsigned char *def = (const unsigned char *)&settings_default;
+
+    row = (settings_row == SETTINGS_NO_ROW) ? 0 : (settings_row + 1) % SETTINGS_ROWS;
+    hef_erase_row(SETTINGS_ROW_ADDR(row));
+    settings_next = SETTINGS_HEADER_LEN;
+
+    for( first = 0; first < sizeof(settings) && image[first] == def[first]; first++ )
+        ;
+    if( first < sizeof(settings) )
+    {
+        for( last = sizeof(settings) - 1; image[last] == def[last]; last-- )
+            ;
+        record[0] = first | SETTINGS_RUN;
+        record[1] = last - first + 1;
+        hef_write_bytes(SETTINGS_ROW_ADDR(row) + settings_next, record, SETTINGS_RECORD_LEN);
+        settings_next += SETTINGS_RECORD_LEN;
+        hef_write_bytes(SETTINGS_ROW_ADDR(row) + settings_next, image + first, record[1]);
+        settings_next += record[1];
+    }
+
+    settings_seq++;
+    record[0] = SETTINGS_TAG;
+    record[1] = settings_seq;
+    hef_write_bytes(SETTINGS_ROW_ADDR(row), record, SETTINGS_HEADER_LEN);
+    settings_row = row;
+}
+
+// 設定を1バイト変更する
+// 書き込み中(最大5ms程度)はCPUが停止するので、メインループから呼ぶこと
+void settings_write(unsigned char offset, unsigned char value)
+{
+    unsigned char record[SETTINGS_RECORD_LEN];
+    unsigned char *image = (unsigned char *)&settings;
+
+    if( offset >= sizeof(settings) || image[offset] == value )
+        return;
+
+    image[offset] = value;
+    if( settings_row == SETTINGS_NO_ROW || settings_next + SETTINGS_RECORD_LEN > HEF_ROW_SIZE )
+    {
+        settings_compact();
+    }
+    else
+    {
+        record[0] = offset;
+        record[1] = value;
+        hef_write_bytes(SETTINGS_ROW_ADDR(settings_row) + settings_next, record, SETTINGS_RECORD_LEN);
+        settings_next += SETTINGS_RECORD_LEN;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_SETTINGS_H_
+#define _IR_REMOCON_ANALYZER_SETTINGS_H_
+
+#include <stddef.h>
+#include "main.h"
+
+#define SETTINGS_VERSION    1           // settings_tのレイアウトを変えたら更新する(0〜15)
+
+typedef struct {
+    unsigned char   key_custom[2];                      // NECのカスタムコード
+    unsigned char   key_data[KEYCODE_MAX - KEYCODE_OFF];// 各キー(KEYCODE_OFF〜)のデータコード
+    unsigned char   longpush_time;                      // 電源ボタン長押しの時間(100ms単位)
+    unsigned char   leader_coeff_min;                   // リーダー判定の下限(%)
+    unsigned char   leader_coeff_max;                   // リーダー判定の上限(%)
+    unsigned int    beep_hi;                            // ブザー(高音)のNCOカウント
+    unsigned int    beep_lo;                            // ブザー(低音)のNCOカウント
+    unsigned char   beep_off_time;                      // 電源オフ時のブザー時間(10ms単位)
+    unsigned char   beep_on_time;                       // 電源オン時のブザー時間(10ms単位, 高音・低音それぞれ)
+    unsigned char   beep_ack_time;                      // 受信のみの場合のブザー時間(10ms単位)
+    unsigned char   key_confirm[(KEYCODE_MAX - KEYCODE_OFF + 1) / 2];   // 各キーの動作に必要な同一フレームの連続受信数(4bitずつ, 0と1は1フレーム)
+    unsigned char   timer_step;                         // +/-キーで予約する時間の単位(分)
+} settings_t;
+
+extern settings_t settings;
+#define SETTINGS settings
+
+// key_confirmは下位4bitが偶数番目、上位4bitが奇数番目のキー(KEYCODE_OFF〜)
+#define SETTINGS_CONFIRM(V0, V1)    ((unsigned char)((V0) | ((V1) << 4)))
+#define SETTINGS_KEY_CONFIRM(KEY)   ((((KEY) - KEYCODE_OFF) & 1) != 0 \
+                                        ? (SETTINGS.key_confirm[((KEY) - KEYCODE_OFF) / 2] >> 4) \
+                                        : (SETTINGS.key_confirm[((KEY) - KEYCODE_OFF) / 2] & 0x0F))
+
+#define SETTINGS_OFFSET(M)  ((unsigned char)offsetof(settings_t, M))
+
+void settings_init(void);
+void settings_write(unsigned char offset, unsigned char value);
+
+#endif // _IR_REMOCON_ANALYZER_SETTINGS_H_
@@ -0,0 +1,411 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    UARTブートローダー(bootloader/)でアプリケーションを書き込む
+
+    ビルド(リポジトリのトップで):
+        cc -O2 -I. -Ibootloader -o bootload tools/bootload.c
+    使い方: bootload <シリアルポート> <アプリケーションのHEXファイル>
+        例: bootload /dev/ttyUSB0 out/pc-remocon/default.hex
+
+    アプリケーションは -mcodeoffset=0x200 でビルドしておくこと(0x200より前にデータがあればエラー)。
+    動作中のアプリケーションにUARTのBOOTを送ってブートローダーを起動し、ROW_CRCで各行のCRCを比較して
+    内容の変わった行だけを書き込む。最後にFINISHで全体のCRCを確認するとアプリケーションが起動する。
+    HEF(0xF80〜)とコンフィギュレーションはHEXファイルにあっても書き込まない(設定と統計は保持される)。
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+#include "uart.h"
+#include "bootloader.h"
+
+#define TIMEOUT_MS          500     // 応答の待ち時間(1行の消去・書き込みは約5ms)
+#define RETRY_MAX           3
+#define BOOT_WAIT_MS        100     // BOOTの応答からブートローダーが起動するまでの待ち時間
+#define IMAGE_WORDS         BOOT_APP_END
+#define APP_ROWS            ((BOOT_APP_END - BOOT_APP_START) / BOOT_ROW_SIZE)
+
+static unsigned int image[IMAGE_WORDS];
+static int port = -1;
+
+static double now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+static unsigned char crc8(unsigned char crc, unsigned char data)
+{
+    int i;
+
+    crc ^= data;
+    for( i = 0; i < 8; i++ )
+        crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    return crc;
+}
+
+static unsigned int crc16(unsigned int crc, unsigned int addr, unsigned int count)
+{
+    unsigned int word;
+    int i, n;
+
+    for( ; count > 0; count--, addr++ )
+    {
+        word = image[addr];
+        for( n = 0; n < 2; n++, word >>= 8 )
+        {
+            crc ^= (word & 0xFF) << 8;
+            for( i = 0; i < 8; i++ )
+                crc = ((crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1)) & 0xFFFF;
+        }
+    }
+    return crc;
+}
+
+//--------------------------------------------------------------------------------
+// HEXファイル(Intel HEX)
+
+static int hex_byte(const char *p)
+{
+    unsigned int v;
+
+    if( sscanf(p, "%2x", &v) != 1 )
+        return -1;
+    return (int)v;
+}
+
+static int load_hex(const char *path)
+{
+    FILE *fp;
+    char line[600];
+    unsigned long base = 0, addr, word;
+    int lineno = 0, len, type, sum, i, v;
+    int app = 0, skipped = 0;
+
+    if( (fp = fopen(path, "r")) == NULL )
+    {
+        perror(path);
+        return -1;
+    }
+    for( i = 0; i < IMAGE_WORDS; i++ )
+        image[i] = 0x3FFF;
+
+    while( fgets(line, sizeof(line), fp) != NULL )
+    {
+        lineno++;
+        if( line[0] != ':' )
+            continue;
+        len = hex_byte(&line[1]);
+        if( len < 0 || strlen(line) < (size_t)(11 + len * 2) )
+            goto bad;
+        sum = 0;
+        for( i = 0; i < len + 5; i++ )
+        {
+            if( (v = hex_byte(&line[1 + i * 2])) < 0 )
+                goto bad;
+            sum += v;
+        }
+        if( (sum & 0xFF) != 0 )
+            goto bad;
+
+        type = hex_byte(&line[7]);
+        addr = base + ((unsigned long)hex_byte(&line[3]) << 8) + hex_byte(&line[5]);
+        if( type == 0x01 )
+            break;
+        if( type == 0x04 )
+        {
+            base = (unsigned long)((hex_byte(&line[9]) << 8) | hex_byte(&line[11])) << 16;
+            continue;
+        }
+        if( type != 0x00 )
+            continue;
+
+        // HEXファイルはバイトアドレス(ワードの下位・上位の順)
+        for( i = 0; i < len; i++, addr++ )
+        {
+            v = hex_byte(&line[9 + i * 2]);
+            word = addr / 2;
+            if( word < BOOT_APP_START )
+            {
+                fprintf(stderr, "%s: data at 0x%04lx (build the application with -mcodeoffset=0x%x)\n",
+                    path, word, BOOT_APP_START);
+                fclose(fp);
+                return -1;
+            }
+            if( word >= BOOT_APP_END )
+            {
+                skipped++;      // HEF, コンフィギュレーション等
+                continue;
+            }
+            if( (addr & 1) == 0 )
+                image[word] = (image[word] & 0x3F00) | v;
+            else
+                image[word] = (image[word] & 0x00FF) | ((v & 0x3F) << 8);
+            app++;
+        }
+    }
+    fclose(fp);
+
+    if( app == 0 )
+    {
+        fprintf(stderr, "%s: no application data\n", path);
+        return -1;
+    }
+    if( skipped != 0 )
+        printf("skipped %d bytes outside 0x%04x-0x%04x\n", skipped, BOOT_APP_START, BOOT_APP_END - 1);
+    return 0;
+
+bad:
+    fprintf(stderr, "%s:%d: bad record\n", path, lineno);
+    fclose(fp);
+    return -1;
+}
+
+//--------------------------------------------------------------------------------
+// UART
+
+static int open_port(const char *path)
+{
+    struct termios tio;
+
+    if( (port = open(path, O_RDWR | O_NOCTTY)) < 0 )
+    {
+        perror(path);
+        return -1;
+    }
+    if( tcgetattr(port, &tio) != 0 )
+    {
+        perror(path);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if( tcsetattr(port, TCSANOW, &tio) != 0 )
+    {
+        perror(path);
+        return -1;
+    }
+    tcflush(port, TCIOFLUSH);
+    return 0;
+}
+
+static int read_byte(double deadline)
+{
+    fd_set fds;
+    struct timeval tv;
+    double remain;
+    unsigned char c;
+
+    while( (remain = deadline - now_ms()) > 0 )
+    {
+        FD_ZERO(&fds);
+        FD_SET(port, &fds);
+        tv.tv_sec = (long)(remain / 1e3);
+        tv.tv_usec = (long)(remain * 1e3) % 1000000;
+        if( select(port + 1, &fds, NULL, NULL, &tv) > 0 && read(port, &c, 1) == 1 )
+            return c;
+    }
+    return -1;
+}
+
+static void send_frame(unsigned char cmd, const unsigned char *data, int len)
+{
+    unsigned char buf[4 + BOOT_PAYLOAD_MAX];
+    unsigned char crc;
+    int i, n = 0;
+
+    buf[n++] = BOOT_SOF;
+    buf[n++] = cmd;
+    buf[n++] = (unsigned char)len;
+    crc = crc8(crc8(0, cmd), (unsigned char)len);
+    for( i = 0; i < len; i++ )
+    {
+        buf[n++] = data[i];
+        crc = crc8(crc, data[i]);
+    }
+    buf[n++] = crc;
+    if( write(port, buf, n) != n )
+        perror("write");
+}
+
+// 応答(cmd | 0x80)のデータ長を返す。タイムアウト・CRC不一致は-1, エラー応答は-2
+static int recv_frame(unsigned char cmd, unsigned char *data, int max)
+{
+    double deadline = now_ms() + TIMEOUT_MS;
+    int c, rcmd, len, i;
+    unsigned char crc;
+
+    while( 1 )
+    {
+        if( (c = read_byte(deadline)) < 0 )
+            return -1;
+        if( c != BOOT_SOF )
+            continue;
+        if( (rcmd = read_byte(deadline)) < 0 || (len = read_byte(deadline)) < 0 )
+            return -1;
+        crc = crc8(crc8(0, rcmd), len);
+        for( i = 0; i < len; i++ )
+        {
+            if( (c = read_byte(deadline)) < 0 )
+                return -1;
+            if( i < max )
+                data[i] = c;
+            crc = crc8(crc, c);
+        }
+        if( (c = read_byte(deadline)) < 0 || c != crc )
+            return -1;
+        if( rcmd == (cmd | BOOT_RESPONSE) )
+            return len < max ? len : max;
+        if( rcmd == BOOT_CMD_ERROR || rcmd == UART_CMD_ERROR )
+            return -2;
+    }
+}
+
+static int request(unsigned char cmd, const unsigned char *req, int req_len, unsigned char *resp, int max)
+{
+    int retry, len = -1;
+
+    for( retry = 0; retry < RETRY_MAX; retry++ )
+    {
+        send_frame(cmd, req, req_len);
+        if( (len = recv_frame(cmd, resp, max)) != -1 )
+            break;
+    }
+    return len;
+}
+
+//--------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    unsigned char req[BOOT_PAYLOAD_MAX];
+    unsigned char resp[BOOT_PAYLOAD_MAX];
+    unsigned int addr, crc, i, n, count;
+    unsigned char changed[APP_ROWS];
+    int len, written = 0, unchanged = 0;
+    double start;
+
+    if( argc != 3 )
+    {
+        fprintf(stderr, "usage: %s <port> <app.hex>\n", argv[0]);
+        return 1;
+    }
+    if( load_hex(argv[2]) != 0 || open_port(argv[1]) != 0 )
+        return 1;
+    start = now_ms();
+
+    // アプリケーションが動作中ならブートローダーを起動させる(既にブートローダーなら応答はない)
+    send_frame(UART_CMD_BOOT, NULL, 0);
+    if( recv_frame(UART_CMD_BOOT, resp, sizeof(resp)) >= 0 )
+        usleep(BOOT_WAIT_MS * 1000);
+    tcflush(port, TCIFLUSH);
+
+    len = request(BOOT_CMD_INFO, NULL, 0, resp, sizeof(resp));
+    if( len != 6 )
+    {
+        fprintf(stderr, "no response from the bootloader\n");
+        return 1;
+    }
+    if( resp[0] != BOOT_VERSION || resp[1] != BOOT_ROW_SIZE
+        || (resp[2] | resp[3] << 8) != BOOT_APP_START || (resp[4] | resp[5] << 8) != BOOT_APP_END )
+    {
+        fprintf(stderr, "bootloader mismatch: version=%u row=%u app=0x%04x-0x%04x\n",
+            resp[0], resp[1], resp[2] | resp[3] << 8, resp[4] | resp[5] << 8);
+        return 1;
+    }
+
+    // 各行のCRCを比較する
+    for( i = 0; i < APP_ROWS; i += count )
+    {
+        count = APP_ROWS - i < BOOT_CRC_ROWS_MAX ? APP_ROWS - i : BOOT_CRC_ROWS_MAX;
+        addr = BOOT_APP_START + i * BOOT_ROW_SIZE;
+        req[0] = addr & 0xFF;
+        req[1] = addr >> 8;
+        req[2] = count;
+        if( request(BOOT_CMD_ROW_CRC, req, 3, resp, sizeof(resp)) != 2 + (int)count * 2 )
+        {
+            fprintf(stderr, "ROW_CRC failed at 0x%04x\n", addr);
+            return 1;
+        }
+        for( n = 0; n < count; n++ )
+        {
+            crc = resp[2 + n * 2] | resp[3 + n * 2] << 8;
+            changed[i + n] = crc != crc16(BOOT_CRC_INIT, addr + n * BOOT_ROW_SIZE, BOOT_ROW_SIZE);
+        }
+    }
+
+    // 変わった行だけを書き込む
+    for( i = 0; i < APP_ROWS; i++ )
+    {
+        if( changed[i] == 0 )
+        {
+            unchanged++;
+            continue;
+        }
+        addr = BOOT_APP_START + i * BOOT_ROW_SIZE;
+        req[0] = addr & 0xFF;
+        req[1] = addr >> 8;
+        for( n = 0; n < BOOT_ROW_SIZE; n++ )
+        {
+            req[2 + n * 2] = image[addr + n] & 0xFF;
+            req[3 + n * 2] = image[addr + n] >> 8;
+        }
+        len = request(BOOT_CMD_WRITE, req, BOOT_PAYLOAD_MAX, resp, sizeof(resp));
+        if( len != 3 || (resp[2] != BOOT_RESULT_OK && resp[2] != BOOT_RESULT_UNCHANGED) )
+        {
+            fprintf(stderr, "WRITE failed at 0x%04x (result=%d)\n", addr, len == 3 ? resp[2] : -1);
+            return 1;
+        }
+        written++;
+    }
+
+    crc = crc16(BOOT_CRC_INIT, BOOT_APP_START, BOOT_APP_END - BOOT_APP_START);
+    req[0] = crc & 0xFF;
+    req[1] = crc >> 8;
+    len = request(BOOT_CMD_FINISH, req, 2, resp, sizeof(resp));
+    if( len != 1 || resp[0] != BOOT_RESULT_OK )
+    {
+        fprintf(stderr, "FINISH failed (result=%d)\n", len == 1 ? resp[0] : -1);
+        return 1;
+    }
+
+    printf("rows written=%d unchanged=%d, %.2fs\n", written, unchanged, (now_ms() - start) / 1e3);
+    return 0;
+}
@@ -0,0 +1,305 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    static_decoder(コンパイル時に展開)とtable_decoder(実行時のテーブル+エッジごとの換算)の比較
+
+    ビルド(リポジトリのトップで):
+        c++ -std=c++17 -O2 -I. -o irr_bench tools/host_decoder/bench.cpp
+    使い方: irr_bench [フレーム数] [繰り返し回数]
+
+    NEC, 家製協, RC6, RC5のフレームを±5%の揺らぎを付けてBENCH_SAMPLE_HZのカウントで生成し、
+    両方のデコーダーで同じ結果になること、家製協のTrailerの直後ではRC6のリーダーを試さないことを
+    確認してから、エッジ1つあたりの処理時間を表示する。
+    処理時間は両方を交互に繰り返し回数だけ実行した最小値。
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tools/host_decoder/irr_decoder.hpp"
+
+#ifndef BENCH_SAMPLE_HZ
+#define BENCH_SAMPLE_HZ     1000000UL       // ゲートウェイのキャプチャのサンプルクロック
+#endif
+
+namespace {
+
+using clk = irr::sample_clock<BENCH_SAMPLE_HZ>;
+using decoder_t = irr::static_decoder<
+    irr::timing<irr::nec, clk>,
+    irr::timing<irr::aeha, clk>,
+    irr::timing<irr::rc6, clk>,
+    irr::timing<irr::rc5, clk>>;
+
+struct sample {
+    bool    mark;
+    long    width;      // サンプルクロックのカウント。0はフレームの終了
+};
+
+class generator {
+public:
+    explicit generator(unsigned seed) : rng_(seed), jitter_(0.95, 1.05)
+    {
+    }
+
+    void nec(std::vector<sample> &out, const std::uint8_t *d)
+    {
+        pd(out, T_NEC, 16, 8, d, 4);
+    }
+
+    void aeha(std::vector<sample> &out, const std::uint8_t *d, int length)
+    {
+        pd(out, T_AEHA, 8, 4, d, length);
+    }
+
+    void rc6(std::vector<sample> &out, int toggle, int addr, int cmd)
+    {
+        std::uint32_t v = (1u << 20) | (toggle << 16) | (addr << 8) | cmd;
+        halves_.clear();
+        half(1, 6 * T_RC6);
+        half(0, 2 * T_RC6);
+        for( int b = 20; b >= 0; b-- )
+        {
+            int bit = (v >> b) & 1;
+            double d = (b == 16) ? 2 * T_RC6 : T_RC6;
+            half(bit, d);
+            half(!bit, d);
+        }
+        flush(out);
+    }
+
+    void rc5(std::vector<sample> &out, int toggle, int addr, int cmd)
+    {
+        std::uint32_t v = (1u << 13) | ((((cmd >> 6) & 1) ^ 1) << 12) | (toggle << 11) | (addr << 6) | (cmd & 0x3F);
+        halves_.clear();
+        for( int b = 13; b >= 0; b-- )
+        {
+            int bit = (v >> b) & 1;
+            half(!bit, T_RC5);
+            half(bit, T_RC5);
+        }
+        flush(out);
+    }
+
+    unsigned rand(unsigned n)
+    {
+        return std::uniform_int_distribution<unsigned>(0, n - 1)(rng_);
+    }
+
+private:
+    long count(double seconds)
+    {
+        return static_cast<long>(seconds * jitter_(rng_) * BENCH_SAMPLE_HZ);
+    }
+
+    void pd(std::vector<sample> &out, double t, int lh, int ll, const std::uint8_t *d, int length)
+    {
+        out.push_back({ true, count(t * lh) });
+        out.push_back({ false, count(t * ll) });
+        for( int i = 0; i < length; i++ )
+        {
+            for( int b = 0; b < 8; b++ )
+            {
+                out.push_back({ true, count(t) });
+                out.push_back({ false, count(((d[i] >> b) & 1) ? t * 3 : t) });
+            }
+        }
+        out.push_back({ true, count(t) });
+        out.push_back({ false, 0 });
+    }
+
+    // マンチェスター符号: 同じレベルの半ビットをまとめ、先頭のLと最後のLは測定されない
+    void half(int level, double d)
+    {
+        if( !halves_.empty() && halves_.back().first == level )
+            halves_.back().second += d;
+        else
+            halves_.push_back({ level, d });
+    }
+
+    void flush(std::vector<sample> &out)
+    {
+        std::size_t i = (halves_[0].first == 0) ? 1 : 0;
+        for( ; i < halves_.size(); i++ )
+        {
+            if( halves_[i].first )
+                out.push_back({ true, count(halves_[i].second) });
+            else if( i + 1 != halves_.size() )
+                out.push_back({ false, count(halves_[i].second) });
+        }
+        out.push_back({ false, 0 });
+    }
+
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> jitter_;
+    std::vector<std::pair<int, double>> halves_;
+};
+
+template <class Decoder>
+unsigned long run(Decoder &dec, const std::vector<sample> &capture, std::vector<irr::frame_t> *frames)
+{
+    unsigned long ok = 0;
+
+    for( const sample &s : capture )
+    {
+        if( s.width != 0 )
+        {
+            dec.feed(s.mark, s.width);
+        }
+        else if( dec.end() == irr::error::none )
+        {
+            ok++;
+            if( frames != nullptr )
+                frames->push_back(dec.frame());
+        }
+    }
+    return ok;
+}
+
+// 家製協のTrailerの直後にRC6のリーダーに見えるH期間が続いても、RC6は試さずにleader_hで失敗すること
+// (ファームウェアのIRR_FLAG_GAPと同じ)
+template <class Decoder>
+bool check_gap(Decoder &dec)
+{
+    const std::uint8_t d[6] = { 0x23, 0xCB, 0x26, 0x01, 0x00, 0x20 };
+    auto count = [](double seconds) { return static_cast<long>(seconds * BENCH_SAMPLE_HZ); };
+
+    dec.feed(true, count(T_AEHA * 8));
+    dec.feed(false, count(T_AEHA * 4));
+    for( int i = 0; i < 6; i++ )
+    {
+        for( int b = 0; b < 8; b++ )
+        {
+            dec.feed(true, count(T_AEHA));
+            dec.feed(false, count(((d[i] >> b) & 1) ? T_AEHA * 3 : T_AEHA));
+        }
+    }
+    dec.feed(true, count(T_AEHA));
+    dec.feed(false, count(8e-3));
+    dec.feed(true, count(T_RC6 * 6));
+    dec.feed(false, count(T_RC6 * 2));
+    dec.feed(true, count(T_RC6));
+    return dec.end() == irr::error::leader_h;
+}
+
+// 1回分の処理時間(ns/edge)
+template <class Decoder>
+double measure(Decoder &dec, const std::vector<sample> &capture)
+{
+    auto start = std::chrono::steady_clock::now();
+    run(dec, capture, nullptr);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(capture.size());
+}
+
+}   // namespace
+
+int main(int argc, char *argv[])
+{
+    int count = (argc > 1) ? std::atoi(argv[1]) : 10000;
+    int repeat = (argc > 2) ? std::atoi(argv[2]) : 20;
+    generator gen(1);
+    std::vector<sample> capture;
+    std::vector<irr::frame_t> frames_s, frames_t;
+    std::uint8_t d[8];
+
+    for( int i = 0; i < count; i++ )
+    {
+        switch( gen.rand(4) )
+        {
+            case 0:
+                d[0] = gen.rand(256);
+                d[1] = gen.rand(256);
+                d[2] = gen.rand(256);
+                d[3] = d[2] ^ 0xFF;
+                gen.nec(capture, d);
+                break;
+            case 1:
+                d[0] = 0x23;
+                d[1] = 0xCB;
+                d[2] = ((0x2 ^ 0x3 ^ 0xB ^ 0xC) & 0x0F) | (gen.rand(16) << 4);
+                for( int j = 3; j < 6; j++ )
+                    d[j] = gen.rand(256);
+                gen.aeha(capture, d, 6);
+                break;
+            case 2:
+                gen.rc6(capture, gen.rand(2), gen.rand(256), gen.rand(256));
+                break;
+            default:
+                gen.rc5(capture, gen.rand(2), gen.rand(32), gen.rand(128));
+                break;
+        }
+    }
+
+    decoder_t dec_s;
+    irr::table_decoder dec_t({
+        irr::runtime_timing::make<irr::nec>(500e3),
+        irr::runtime_timing::make<irr::aeha>(500e3),
+        irr::runtime_timing::make<irr::rc6>(500e3),
+        irr::runtime_timing::make<irr::rc5>(500e3),
+    }, BENCH_SAMPLE_HZ);
+
+    run(dec_s, capture, &frames_s);
+    run(dec_t, capture, &frames_t);
+    std::printf("sample clock %lu Hz, %d frames, %zu edges\n", static_cast<unsigned long>(BENCH_SAMPLE_HZ), count, capture.size());
+    std::printf("decoded: static %zu, table %zu\n", frames_s.size(), frames_t.size());
+    if( frames_s.size() != frames_t.size() )
+    {
+        std::printf("MISMATCH: frame count\n");
+        return 1;
+    }
+    for( std::size_t i = 0; i < frames_s.size(); i++ )
+    {
+        if(    frames_s[i].type != frames_t[i].type
+            || frames_s[i].length != frames_t[i].length
+            || std::memcmp(frames_s[i].data, frames_t[i].data, frames_s[i].length) != 0 )
+        {
+            std::printf("MISMATCH: frame %zu\n", i);
+            return 1;
+        }
+    }
+
+    if( !check_gap(dec_s) || !check_gap(dec_t) )
+    {
+        std::printf("MISMATCH: RC6 leader after an AEHA trailer\n");
+        return 1;
+    }
+
+    // 周波数の変動やキャッシュの影響を揃えるため交互に実行し、それぞれの最小値を比べる
+    double ns_s = 1e9, ns_t = 1e9;
+    for( int r = 0; r < repeat; r++ )
+    {
+        ns_s = std::min(ns_s, measure(dec_s, capture));
+        ns_t = std::min(ns_t, measure(dec_t, capture));
+    }
+    std::printf("static_decoder: %6.2f ns/edge (min of %d)\n", ns_s, repeat);
+    std::printf("table_decoder:  %6.2f ns/edge (x%.2f)\n", ns_t, ns_t / ns_s);
+    return 0;
+}
@@ -0,0 +1,629 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    ホスト(Linux)用の赤外線デコーダー
+
+    ファームウェア(ir_receiver.c)と同じ判定をC++のテンプレートで実装する。
+    プロトコルごとの時間(リーダーの判定範囲、0/1の閾値)はサンプルクロックをテンプレート引数にして
+    コンパイル時に計算するので、デコードのループにはテーブルの読み込みも換算の計算も残らない。
+
+        using clk = irr::sample_clock<1000000>;         // キャプチャのサンプルクロック(Hz)
+        irr::static_decoder<irr::timing<irr::nec, clk>, irr::timing<irr::aeha, clk>> dec;
+        dec.feed(true, width_h); dec.feed(false, width_l); ...
+        if( dec.end() == irr::error::none ) { dec.frame() ... }
+
+    比較用に、ファームウェアと同じくSMTクロック(500kHz)のテーブルを実行時に参照し、
+    エッジごとにサンプルクロックから換算するtable_decoderも用意している(bench.cpp)。
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_IRR_DECODER_HPP_
+#define _IR_REMOCON_ANALYZER_IRR_DECODER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ir_protocol.h"
+
+namespace irr {
+
+constexpr std::size_t data_maxlen = 48;         // ir_receiver.cのDATA_MAXLEN
+constexpr unsigned extend_max = 4;              // DATA_EXTEND_MAX
+constexpr unsigned mc_units_max = 3;            // MC_UNITS_MAX
+constexpr unsigned no_wide_bit = 0xFF;          // IRR_NO_WIDE_BIT
+
+// irr_error_tと同じ並び
+enum class error : std::uint8_t {
+    none = 0,
+    state_h,
+    state_l,
+    leader_h,
+    leader_l,
+    data_h,
+    data_l,
+    data_check,
+    data_overrun,
+    data_phase,
+};
+
+enum class coding : std::uint8_t {
+    pulse_distance,     // NEC, 家製協
+    manchester,         // RC5, RC6
+};
+
+struct frame_t {
+    irr_type_t      type = IRR_TYPE_NEC;
+    std::uint8_t    length = 0;
+    std::uint8_t    data[data_maxlen] = {};
+};
+
+// デコード中の状態(ir_receiver.cのirr_data_analyze_t)
+struct context {
+    enum class state : std::uint8_t { idle, leader, data };
+
+    state           st = state::idle;
+    error           err = error::none;
+    int             active = -1;        // 選択したプロトコル
+    bool            in_frame = false;   // フレームの最初のエッジを受信した(ファームウェアのin_frame)
+    std::uint8_t    work_byte = 0;
+    std::uint8_t    work_bitpos = 0;
+    std::uint8_t    extended_count = 0;
+    std::uint8_t    mc_half = 0;
+    std::uint8_t    mc_first = 0;
+    std::uint8_t    mc_count = 0;
+    std::uint32_t   mc_bits = 0;
+    frame_t         frame;
+
+    void reset()
+    {
+        *this = context();
+    }
+
+    void fail(error e)
+    {
+        err = e;
+    }
+
+    void store_byte(std::uint8_t byte)
+    {
+        if( frame.length < data_maxlen )
+            frame.data[frame.length++] = byte;
+        else
+            fail(error::data_overrun);
+    }
+};
+
+// ---- プロトコル(単位時間Tとその倍数) ----
+
+struct nec {
+    static constexpr irr_type_t type = IRR_TYPE_NEC;
+    static constexpr coding code = coding::pulse_distance;
+    static constexpr double t = T_NEC;
+    static constexpr double leader_h = 16, leader_l = 8, data_th = 2, data_max = 4;
+    static constexpr bool extend = false;
+    static constexpr bool has_leader = true;
+    static constexpr bool gap = false;
+    static constexpr std::uint8_t mc_invert = 0;
+    static constexpr unsigned mc_wide_bit = no_wide_bit;
+
+    static error validate(context &c)
+    {
+        const frame_t &f = c.frame;
+        if( f.length == 4 && f.data[2] == static_cast<std::uint8_t>(f.data[3] ^ 0xFF) )
+            return error::none;
+        return error::data_check;
+    }
+};
+
+struct aeha {
+    static constexpr irr_type_t type = IRR_TYPE_AEHA;
+    static constexpr coding code = coding::pulse_distance;
+    static constexpr double t = T_AEHA;
+    static constexpr double leader_h = 8, leader_l = 4, data_th = 2, data_max = 4;
+    static constexpr bool extend = true;
+    static constexpr bool has_leader = true;
+    static constexpr bool gap = false;
+    static constexpr std::uint8_t mc_invert = 0;
+    static constexpr unsigned mc_wide_bit = no_wide_bit;
+
+    static error validate(context &c)
+    {
+        const std::uint8_t *d = c.frame.data;
+        if(    c.frame.length >= 4
+            && ((d[0] & 0x0F) ^ (d[0] >> 4) ^ (d[1] & 0x0F) ^ (d[1] >> 4)) == (d[2] & 0x0F) )
+            return error::none;
+        return error::data_check;
+    }
+};
+
+// 最後のL期間は測定されないので、前半だけ受信したビットを補完する
+inline void mc_flush(context &c, std::uint8_t invert);
+
+struct rc6 {
+    static constexpr irr_type_t type = IRR_TYPE_RC6;
+    static constexpr coding code = coding::manchester;
+    static constexpr double t = T_RC6;
+    static constexpr double leader_h = 6, leader_l = 2, data_th = 1, data_max = 0;
+    static constexpr bool extend = false;
+    static constexpr bool has_leader = true;
+    static constexpr bool gap = true;           // IRR_FLAG_GAP: フレームの先頭でのみリーダーを判定する
+    static constexpr std::uint8_t mc_invert = 1;
+    static constexpr unsigned mc_wide_bit = 4;
+
+    static error validate(context &c)
+    {
+        mc_flush(c, mc_invert);
+        if( c.err != error::none )
+            return c.err;
+        if( c.mc_count != 21 || ((c.mc_bits >> 20) & 1) == 0 )
+            return error::data_check;
+        c.store_byte((c.mc_bits >> 17) & 0x07);
+        c.store_byte((c.mc_bits >> 16) & 0x01);
+        c.store_byte((c.mc_bits >> 8) & 0xFF);
+        c.store_byte(c.mc_bits & 0xFF);
+        return error::none;
+    }
+};
+
+struct rc5 {
+    static constexpr irr_type_t type = IRR_TYPE_RC5;
+    static constexpr coding code = coding::manchester;
+    static constexpr double t = T_RC5;
+    static constexpr double leader_h = 0, leader_l = 0, data_th = 1, data_max = 0;
+    static constexpr double first_min = 0.5, first_max = 2.5;   // 最初のH期間(S1の後半)
+    static constexpr bool extend = false;
+    static constexpr bool has_leader = false;
+    static constexpr bool gap = true;
+    static constexpr std::uint8_t mc_invert = 0;
+    static constexpr unsigned mc_wide_bit = no_wide_bit;
+
+    static error validate(context &c)
+    {
+        mc_flush(c, mc_invert);
+        if( c.err != error::none )
+            return c.err;
+        if( c.mc_count != 14 || ((c.mc_bits >> 13) & 1) == 0 )
+            return error::data_check;
+        c.store_byte((c.mc_bits >> 6) & 0x1F);
+        c.store_byte((c.mc_bits & 0x3F) | ((((c.mc_bits >> 12) & 1) ^ 1) << 6));
+        c.store_byte((c.mc_bits >> 11) & 0x01);
+        return error::none;
+    }
+};
+
+// ---- 時間(サンプルクロックのカウント) ----
+
+template <unsigned long Hz>
+struct sample_clock {
+    static constexpr unsigned long hz = Hz;
+    // SMT_COUNTと同じく切り捨て
+    static constexpr long count(double seconds)
+    {
+        return static_cast<long>(seconds * Hz);
+    }
+};
+
+// コンパイル時に計算した判定範囲。メンバーはすべてstatic constexpr
+template <class Proto, class Clock, int CoeffMin = 90, int CoeffMax = 110>
+struct timing {
+    using protocol = Proto;
+    static constexpr irr_type_t type = Proto::type;
+    static constexpr coding code = Proto::code;
+    static constexpr bool extend = Proto::extend;
+    static constexpr bool has_leader = Proto::has_leader;
+    static constexpr bool gap = Proto::gap;
+    static constexpr std::uint8_t mc_invert = Proto::mc_invert;
+    static constexpr unsigned mc_wide_bit = Proto::mc_wide_bit;
+
+    static constexpr long leader_h_min = Clock::count(Proto::t * Proto::leader_h) * CoeffMin / 100;
+    static constexpr long leader_h_max = Clock::count(Proto::t * Proto::leader_h) * CoeffMax / 100;
+    static constexpr long leader_l_min = Clock::count(Proto::t * Proto::leader_l) * CoeffMin / 100;
+    static constexpr long leader_l_max = Clock::count(Proto::t * Proto::leader_l) * CoeffMax / 100;
+    static constexpr long data_th = Clock::count(Proto::t * Proto::data_th);
+    static constexpr long data_max = Clock::count(Proto::t * Proto::data_max);
+    static constexpr long first_min = Proto::has_leader ? 0 : Clock::count(Proto::t * 0.5);
+    static constexpr long first_max = Proto::has_leader ? 0 : Clock::count(Proto::t * 2.5);
+
+    static error validate(context &c)
+    {
+        return Proto::validate(c);
+    }
+};
+
+// 実行時に参照する判定範囲(ファームウェアのirr_decoders + irr_windowsに相当)
+struct runtime_timing {
+    irr_type_t      type;
+    coding          code;
+    bool            extend;
+    bool            has_leader;
+    bool            gap;
+    std::uint8_t    mc_invert;
+    unsigned        mc_wide_bit;
+    long            leader_h_min, leader_h_max;
+    long            leader_l_min, leader_l_max;
+    long            data_th, data_max;
+    long            first_min, first_max;
+    error           (*validate)(context &c);
+
+    template <class Proto>
+    static runtime_timing make(double hz, int coeff_min = 90, int coeff_max = 110)
+    {
+        runtime_timing r;
+        r.type = Proto::type;
+        r.code = Proto::code;
+        r.extend = Proto::extend;
+        r.has_leader = Proto::has_leader;
+        r.gap = Proto::gap;
+        r.mc_invert = Proto::mc_invert;
+        r.mc_wide_bit = Proto::mc_wide_bit;
+        r.leader_h_min = static_cast<long>(Proto::t * Proto::leader_h * hz) * coeff_min / 100;
+        r.leader_h_max = static_cast<long>(Proto::t * Proto::leader_h * hz) * coeff_max / 100;
+        r.leader_l_min = static_cast<long>(Proto::t * Proto::leader_l * hz) * coeff_min / 100;
+        r.leader_l_max = static_cast<long>(Proto::t * Proto::leader_l * hz) * coeff_max / 100;
+        r.data_th = static_cast<long>(Proto::t * Proto::data_th * hz);
+        r.data_max = static_cast<long>(Proto::t * Proto::data_max * hz);
+        r.first_min = Proto::has_leader ? 0 : static_cast<long>(Proto::t * 0.5 * hz);
+        r.first_max = Proto::has_leader ? 0 : static_cast<long>(Proto::t * 2.5 * hz);
+        r.validate = &Proto::validate;
+        return r;
+    }
+};
+
+// ---- デコードの処理(Tはtimingまたはruntime_timing) ----
+
+template <class T>
+inline bool leader(context &c, const T &tm, long width_h);
+
+template <class T>
+inline void edge(context &c, const T &tm, bool mark, long width);
+
+// マンチェスター符号の半ビットを1つ処理する
+inline bool mc_half(context &c, std::uint8_t mark, std::uint8_t invert)
+{
+    if( c.mc_half == 0 )
+    {
+        c.mc_first = mark;
+        c.mc_half = 1;
+        return true;
+    }
+    c.mc_half = 0;
+    if( c.mc_first == mark )
+    {
+        c.fail(error::data_phase);
+        return false;
+    }
+    if( c.mc_count >= 32 )
+    {
+        c.fail(error::data_overrun);
+        return false;
+    }
+    c.mc_bits = (c.mc_bits << 1) | (mark ^ invert);
+    c.mc_count++;
+    return true;
+}
+
+inline void mc_flush(context &c, std::uint8_t invert)
+{
+    if( c.mc_half != 0 )
+        mc_half(c, c.mc_first ^ 1, invert);
+}
+
+template <class T>
+inline void pd_edge(context &c, const T &tm, bool mark, long width)
+{
+    if( mark )
+    {
+        if( c.st != context::state::data )
+            c.fail(error::state_h);
+        else if( width >= tm.data_th )
+            c.fail(error::data_h);
+        return;
+    }
+
+    if( c.st == context::state::leader )
+    {
+        if( width >= tm.leader_l_min && width <= tm.leader_l_max )
+            c.st = context::state::data;
+        else
+            c.fail(error::leader_l);
+        return;
+    }
+
+    if( width < tm.data_th )
+    {
+        c.work_byte &= ~(1 << c.work_bitpos);
+    }
+    else if( width <= tm.data_max )
+    {
+        c.work_byte |= (1 << c.work_bitpos);
+    }
+    else
+    {
+        // Trailerの後に再度Leaderが来る場合は続きのデータを受信する
+        if( tm.extend && c.extended_count < extend_max )
+        {
+            c.extended_count++;
+            c.st = context::state::idle;
+            return;
+        }
+        c.fail(error::data_l);
+        return;
+    }
+
+    if( ++c.work_bitpos >= 8 )
+    {
+        c.store_byte(c.work_byte);
+        c.work_byte = 0;
+        c.work_bitpos = 0;
+    }
+}
+
+template <class T>
+inline void mc_edge(context &c, const T &tm, bool mark, long width)
+{
+    unsigned units = 0;
+    unsigned need;
+    const long unit = tm.data_th;
+
+    if( c.st == context::state::leader )
+    {
+        if( mark )
+            c.fail(error::state_h);
+        else if( width >= tm.leader_l_min && width <= tm.leader_l_max )
+            c.st = context::state::data;
+        else
+            c.fail(error::leader_l);
+        return;
+    }
+
+    width += unit >> 1;
+    while( width >= unit && units <= mc_units_max )
+    {
+        width -= unit;
+        units++;
+    }
+    if( units == 0 || units > mc_units_max )
+    {
+        c.fail(mark ? error::data_h : error::data_l);
+        return;
+    }
+    while( units > 0 )
+    {
+        need = (c.mc_count == tm.mc_wide_bit) ? 2 : 1;
+        if( units < need )
+        {
+            c.fail(mark ? error::data_h : error::data_l);
+            return;
+        }
+        units -= need;
+        if( !mc_half(c, mark ? 1 : 0, tm.mc_invert) )
+            return;
+    }
+}
+
+template <class T>
+inline void edge(context &c, const T &tm, bool mark, long width)
+{
+    if( tm.code == coding::pulse_distance )
+        pd_edge(c, tm, mark, width);
+    else
+        mc_edge(c, tm, mark, width);
+}
+
+template <class T>
+inline bool leader(context &c, const T &tm, long width_h)
+{
+    if( tm.has_leader )
+    {
+        if( width_h >= tm.leader_h_min && width_h <= tm.leader_h_max )
+        {
+            c.st = context::state::leader;
+            return true;
+        }
+        return false;
+    }
+    // RC5: 最初のH期間はS1の後半。前半(L)は受信済みとして扱う
+    if( width_h >= tm.first_min && width_h <= tm.first_max )
+    {
+        c.mc_first = 0;
+        c.mc_half = 1;
+        c.st = context::state::data;
+        mc_edge(c, tm, true, width_h);
+        return c.err == error::none;
+    }
+    return false;
+}
+
+// 一致しなかったリーダーの判定(RC5は最初のH期間を処理する)を取り消す
+inline void undo_leader(context &c)
+{
+    c.st = context::state::idle;
+    c.err = error::none;
+    c.mc_half = 0;
+    c.mc_first = 0;
+    c.mc_count = 0;
+    c.mc_bits = 0;
+}
+
+// ---- デコーダー ----
+
+// コンパイル時に展開するデコーダー。Timingsはtiming<...>で、リーダーの判定はこの順に行う
+template <class... Timings>
+class static_decoder {
+public:
+    void feed(bool mark, long width)
+    {
+        bool first = !c_.in_frame;
+
+        c_.in_frame = true;
+        if( c_.err != error::none )
+            return;
+        if( c_.st == context::state::idle )
+        {
+            if( !mark )
+            {
+                c_.fail(error::state_l);
+                return;
+            }
+            if( !find_leader(width, first, std::make_index_sequence<sizeof...(Timings)>()) )
+                c_.fail(error::leader_h);
+            return;
+        }
+        dispatch(mark, width, std::make_index_sequence<sizeof...(Timings)>());
+    }
+
+    // フレームの終了(SMTの周期一致)。戻り値がerror::noneならframe()が有効
+    error end()
+    {
+        error e = c_.err;
+
+        if( e == error::none && c_.st == context::state::data )
+            e = validate(std::make_index_sequence<sizeof...(Timings)>());
+        else if( e == error::none )
+            e = error::state_h;
+        frame_ = c_.frame;
+        c_.reset();
+        return e;
+    }
+
+    const frame_t &frame() const
+    {
+        return frame_;
+    }
+
+private:
+    template <std::size_t... I>
+    bool find_leader(long width, bool first, std::index_sequence<I...>)
+    {
+        return ( try_leader<I, Timings>(width, first) || ... );
+    }
+
+    template <std::size_t I, class T>
+    bool try_leader(long width, bool first)
+    {
+        // 家製協の続きのフレームは同じプロトコルでも全体を判定し直す(ファームウェアと同じ)
+        // フレームの途中(Trailerの後)では、gapのプロトコルは試さない
+        if( T::gap && !first )
+            return false;
+        if( leader(c_, T(), width) )
+        {
+            c_.active = static_cast<int>(I);
+            c_.frame.type = T::type;
+            return true;
+        }
+        undo_leader(c_);
+        return false;
+    }
+
+    template <std::size_t... I>
+    void dispatch(bool mark, long width, std::index_sequence<I...>)
+    {
+        (void)( (c_.active == static_cast<int>(I) ? (edge(c_, Timings(), mark, width), true) : false) || ... );
+    }
+
+    template <std::size_t... I>
+    error validate(std::index_sequence<I...>)
+    {
+        error e = error::none;
+        (void)( (c_.active == static_cast<int>(I) ? (e = Timings::validate(c_), true) : false) || ... );
+        return e;
+    }
+
+    context c_;
+    frame_t frame_;
+};
+
+// 実行時のテーブルを参照するデコーダー。判定範囲はtable_hz(SMTは500kHz)のカウントで持ち、
+// 入力のサンプルクロックからエッジごとに換算する
+class table_decoder {
+public:
+    table_decoder(std::vector<runtime_timing> table, double sample_hz, double table_hz = 500e3)
+        : table_(std::move(table)), scale_(table_hz / sample_hz)
+    {
+    }
+
+    void feed(bool mark, long width)
+    {
+        long w = static_cast<long>(width * scale_);
+        bool first = !c_.in_frame;
+        std::size_t i;
+
+        c_.in_frame = true;
+        if( c_.err != error::none )
+            return;
+        if( c_.st == context::state::idle )
+        {
+            if( !mark )
+            {
+                c_.fail(error::state_l);
+                return;
+            }
+            for( i = 0; i < table_.size(); i++ )
+            {
+                if( table_[i].gap && !first )
+                    continue;
+                if( leader(c_, table_[i], w) )
+                {
+                    c_.active = static_cast<int>(i);
+                    c_.frame.type = table_[i].type;
+                    return;
+                }
+                undo_leader(c_);
+            }
+            c_.fail(error::leader_h);
+            return;
+        }
+        edge(c_, table_[c_.active], mark, w);
+    }
+
+    error end()
+    {
+        error e = c_.err;
+
+        if( e == error::none && c_.st == context::state::data )
+            e = table_[c_.active].validate(c_);
+        else if( e == error::none )
+            e = error::state_h;
+        frame_ = c_.frame;
+        c_.reset();
+        return e;
+    }
+
+    const frame_t &frame() const
+    {
+        return frame_;
+    }
+
+private:
+    std::vector<runtime_timing> table_;
+    double scale_;
+    context c_;
+    frame_t frame_;
+};
+
+}   // namespace irr
+
+#endif // _IR_REMOCON_ANALYZER_IRR_DECODER_HPP_
@@ -0,0 +1,167 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    エネルギーモデル: シミュレーターのCPU状態・クロック・NCOの時間に電流値を掛けて平均電流を求める
+
+    電流値はPIC16F18424のデータシート(Electrical Specifications, Supply Current (IDD/IPD))の
+    VDD=3.0V, 25℃の代表値を目安として入れている。データシートの版や実測値に合わせて更新すること。
+    赤外線受信モジュール等のPIC以外の電流は含まない(ENERGY_BOARD_UAで加算できる)。
+*/
+
+#include <stdio.h>
+#include "sim.h"
+
+#define ENERGY_VDD          3.0         // 電力の計算に使う電圧(V)
+#define ENERGY_BOARD_UA     0.0         // PIC以外の常時電流(uA)
+#define ENERGY_NCO_UA       30.0        // NCO1(MFINTOSC 500kHz)と圧電スピーカーの駆動
+#define ENERGY_MFINTOSC_UA  20.0        // SMT1, TMR4等のMFINTOSC(常時)
+#define ENERGY_SLEEP_UA     0.5         // SLEEP(IPD, LFINTOSCを含む)
+#define ENERGY_DOZE_RATIO   8           // DOZE: CPUは8命令サイクルに1回実行
+
+static const double energy_fosc_mhz[SIM_HFFRQ_MAX] = { 1, 2, 4, 8, 12, 16, 32 };
+
+// 動作中(IDD, HFINTOSC)
+static const double energy_run_ua[SIM_HFFRQ_MAX] = {
+    200, 290, 480, 800, 1100, 1400, 2500,
+};
+
+// IDLE(CPU停止、システムクロックと周辺は動作)
+static const double energy_idle_ua[SIM_HFFRQ_MAX] = {
+    120, 170, 260, 400, 520, 650, 1050,
+};
+
+static const char *energy_state_name[SIM_STATE_MAX] = { "idle", "isr", "main" };
+
+static int energy_idle_mode;            // 待機中のCPU(0=ビジーウェイト, 1=IDLE)
+static sim_time_t energy_time[SIM_STATE_MAX][SIM_HFFRQ_MAX];
+static sim_time_t energy_nco_time;
+static double energy_total;             // C
+
+static double energy_state_ua(sim_state_t state, unsigned char hffrq)
+{
+    if( state == SIM_STATE_IDLE && energy_idle_mode != 0 )
+        return energy_idle_ua[hffrq];
+    return energy_run_ua[hffrq];        // ビジーウェイトの待機中も命令を実行している
+}
+
+// ファームウェアの待機の方法(CLOCK_IDLE_ENABLE)を設定する
+void energy_set_idle(int idle)
+{
+    energy_idle_mode = idle;
+}
+
+void energy_account(sim_state_t state, unsigned char hffrq, int nco, sim_time_t ns)
+{
+    double ua;
+
+    if( hffrq >= SIM_HFFRQ_MAX )
+        hffrq = SIM_HFFRQ_MAX - 1;
+    energy_time[state][hffrq] += ns;
+    ua = energy_state_ua(state, hffrq) + ENERGY_MFINTOSC_UA + ENERGY_BOARD_UA;
+    if( nco != 0 )
+    {
+        energy_nco_time += ns;
+        ua += ENERGY_NCO_UA;
+    }
+    energy_total += ua * 1e-6 * ns * 1e-9;
+}
+
+double energy_charge(void)
+{
+    return energy_total;
+}
+
+// 待機時間をほかのモードで過ごした場合の平均電流(割り込み処理とメインループの動作は同じ)
+static double energy_alternative_ua(int mode, sim_time_t total)
+{
+    double charge = energy_total;
+    double idle_ua;
+    int f;
+
+    for( f = 0; f < SIM_HFFRQ_MAX; f++ )
+    {
+        if( energy_time[SIM_STATE_IDLE][f] == 0 )
+            continue;
+        switch( mode )
+        {
+            case 1:     // IDLE
+                idle_ua = energy_idle_ua[f];
+                break;
+            case 2:     // DOZE
+                idle_ua = energy_idle_ua[f] + (energy_run_ua[f] - energy_idle_ua[f]) / ENERGY_DOZE_RATIO;
+                break;
+            case 3:     // SLEEP
+                idle_ua = ENERGY_SLEEP_UA - ENERGY_MFINTOSC_UA;
+                break;
+            default:    // ビジーウェイト
+                idle_ua = energy_run_ua[f];
+                break;
+        }
+        charge += (idle_ua - energy_state_ua(SIM_STATE_IDLE, f)) * 1e-6 * energy_time[SIM_STATE_IDLE][f] * 1e-9;
+    }
+    return charge / (total * 1e-9) * 1e6;
+}
+
+void energy_report(sim_time_t total)
+{
+    static const char *alt_name[] = {
+        "busy-wait",
+        "IDLE",
+        "DOZE 1:8",
+        "SLEEP (reference only: SMT1/TMR4 stop)",
+    };
+    int s, f;
+    double avg;
+    sim_time_t awake[SIM_STATE_MAX] = { 0 };
+
+    if( total == 0 )
+        return;
+
+    printf("\nenergy model (VDD=%.1fV, typical IDD from datasheet tables)\n", ENERGY_VDD);
+    printf("%-6s %6s %14s %8s %8s\n", "state", "MHz", "time(s)", "share", "uA");
+    for( s = 0; s < SIM_STATE_MAX; s++ )
+    {
+        for( f = 0; f < SIM_HFFRQ_MAX; f++ )
+        {
+            if( energy_time[s][f] == 0 )
+                continue;
+            awake[s] += energy_time[s][f];
+            printf("%-6s %6g %14.6f %7.3f%% %8.0f\n", energy_state_name[s], energy_fosc_mhz[f],
+                energy_time[s][f] * 1e-9, 100.0 * energy_time[s][f] / total, energy_state_ua(s, f));
+        }
+    }
+    printf("nco on: %.3fs\n", energy_nco_time * 1e-9);
+    printf("awake: isr %.6fs (%.4f%%), main %.3fs (%.4f%%)\n",
+        awake[SIM_STATE_ISR] * 1e-9, 100.0 * awake[SIM_STATE_ISR] / total,
+        awake[SIM_STATE_MAIN] * 1e-9, 100.0 * awake[SIM_STATE_MAIN] / total);
+
+    avg = energy_total / (total * 1e-9) * 1e6;
+    printf("average: %.1fuA, %.3fmW, %.2fmAh/day\n", avg, avg * ENERGY_VDD * 1e-3, avg * 24 * 1e-3);
+
+    printf("idle time spent in:\n");
+    for( s = 0; s < 4; s++ )
+        printf("  %-40s %8.1fuA%s\n", alt_name[s], energy_alternative_ua(s, total),
+            s == energy_idle_mode ? " (current)" : "");
+}
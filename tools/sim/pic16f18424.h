@@ -0,0 +1,46 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+// ホストシミュレーター用のpic16f18424.h(使用するSFRはsfr.defに列挙する)
+
+#ifndef _IR_REMOCON_ANALYZER_SIM_PIC16F18424_H_
+#define _IR_REMOCON_ANALYZER_SIM_PIC16F18424_H_
+
+#define SFR(R)              extern volatile unsigned char R;
+#define SFR_BITS(R, ...)    extern volatile unsigned char R; \
+                            typedef struct { __VA_ARGS__ } R##bits_t; \
+                            extern volatile R##bits_t R##bits;
+#include "sfr.def"
+#undef SFR
+#undef SFR_BITS
+
+// 読み出しで状態が変わるレジスタはシミュレーターの関数で代用する
+volatile unsigned char *sim_smt1stat(void);
+#define SMT1STAT            (*sim_smt1stat())
+volatile unsigned char *sim_tmr1l(void);   // TMR1はシミュレーターの時刻から計算する(書き込みは無視)
+volatile unsigned char *sim_tmr1h(void);
+#define TMR1L               (*sim_tmr1l())
+#define TMR1H               (*sim_tmr1h())
+
+#endif // _IR_REMOCON_ANALYZER_SIM_PIC16F18424_H_
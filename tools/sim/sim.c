@@ -0,0 +1,930 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    ファームウェアをホストPCで実行し、赤外線の入力と割り込み処理・メインループの動作をVCDに記録する
+    (デバッグピン(debug_pin.h)と同じ波形と、処理ごとの信号を出力する)。
+    CPUの状態とクロックごとの時間から平均電流を見積もる(energy.c)
+
+    ビルド(リポジトリのトップで):
+        cc -std=gnu99 -funsigned-char -Wno-unknown-pragmas -Itools/sim -I. \
+            -DDEBUG_PIN_ENABLE -DDEBUG_PIN_SIM -o sim \
+            tools/sim/sim.c tools/sim/energy.c tools/sim/sim_sfr.c tools/sim/sim_hef.c \
+            buzzer.c clock.c common.c debug_pin.c interrupts.c ir_receiver.c \
+            ir_transmitter.c pins.c power_stats.c power_timer.c settings.c trace.c uart.c
+    使い方: sim [-o out.vcd] [-v] [-l Hz] [-c 処理=サイクル数]... [-p 時間 | シナリオファイル]
+        -o  VCDを出力する
+        -v  メインループの動作ごとに時刻とキーコードを表示する
+        -l  LFINTOSC(Timer1)の実際の周波数(既定は公称値の31000Hz。予約の校正の確認用)
+        -c  処理は pwa, pra, frame, timeout, timer, led, entry(割り込みの応答とコンテキスト保存)
+        -p  合成した1日の利用プロファイル(sim_profile)を指定した時間だけ実行する(例: -p 24)
+        シナリオファイルを省略した場合は組み込みのシナリオ(全灯 -> OFF)を実行する
+
+    シナリオ(1行に1イベント、#以降はコメント):
+        <時刻ms> nec <16進4バイト> [x<回数>]     NECのフレームを108ms周期で送る
+        <時刻ms> aeha <16進バイト...> [x<回数>]  家製協のフレームを送る
+        <時刻ms> power on|off                   PCの電源LEDの状態
+        <時刻ms> end                            シミュレーションの終了時刻
+
+    割り込み処理の時間は命令を実行せずに見積もる(sim_cyclesの値)。
+    XC8のリストファイルやMPLAB SIMのストップウォッチ、ロジックアナライザの実測値に合わせて -c で上書きする。
+    メインループの時間は__delay_msのループを実行時のクロックで数えるので、クロックの保持漏れも再現する。
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define main firmware_main
+#include "main.c"
+#undef main
+
+#include "sim.h"
+
+// ファームウェアの割り込み処理(ヘッダーでは宣言していない)
+void ir_receiver_pwa_isr(void);
+void ir_receiver_pra_isr(void);
+void ir_receiver_isr(void);
+void ir_receiver_tmr_isr(void);
+void power_timer_isr(void);
+void power_timer_cal_isr(void);
+void power_stats_ioc_isr(void);
+
+#define SIM_TIME_MAX        (~(sim_time_t)0)
+#define SIM_SMT_TICK_NS     2000ULL         // SMT1: MFINTOSC(500kHz)
+#define SIM_TMR4_TICK_NS    4096000ULL      // TMR4: MFINTOSC(31.25kHz) / 128
+#define SIM_FRAME_PERIOD    108000000ULL    // フレームの送信周期
+#define SIM_FRAME_GAP       20000000ULL     // 周期より長いフレームの後の間隔
+#define SIM_CHANGES_MAX     (1 << 20)
+
+// 処理ごとの命令サイクル数の見積もり(-cで上書きする)
+static unsigned long sim_cycles[DEBUG_SRC_MAX] = {
+    [DEBUG_SRC_NONE] =      30,     // 割り込みの応答、コンテキストの保存・復帰、要因の判定(entry)
+    [DEBUG_SRC_PWA] =       150,
+    [DEBUG_SRC_PRA] =       110,
+    [DEBUG_SRC_FRAME] =     450,
+    [DEBUG_SRC_TIMEOUT] =   60,
+    [DEBUG_SRC_MAIN] =      0,      // メインループは__delay_msで時間が決まる
+    [DEBUG_SRC_TIMER] =     40,
+    [DEBUG_SRC_LED] =       60,
+};
+
+static const char *sim_src_name[DEBUG_SRC_MAX] = {
+    "entry", "pwa", "pra", "frame", "timeout", "main", "timer", "led",
+};
+
+typedef enum {
+    SIM_EV_PRA = 0,     // Lの期間の終了(Hの開始)
+    SIM_EV_PWA,         // Hの期間の終了
+    SIM_EV_FRAME,       // SMT1の周期一致(フレームの終了)
+    SIM_EV_POWER,
+} sim_ev_kind_t;
+
+typedef struct {
+    sim_time_t      t;
+    sim_ev_kind_t   kind;
+    unsigned long   arg;        // 幅(ns)または電源の状態
+} sim_event_t;
+
+typedef struct {
+    sim_time_t      t;
+    unsigned long   seq;
+    char            id;
+    double          value;
+} sim_change_t;
+
+typedef struct {
+    unsigned long   count;
+    sim_time_t      busy;
+    sim_time_t      max;
+    sim_time_t      latency_min;
+    sim_time_t      latency_max;
+} sim_stat_t;
+
+static sim_time_t sim_now;
+static sim_state_t sim_state;
+static sim_time_t sim_main_start;
+static sim_time_t sim_end;
+static sim_time_t sim_tmr4_at = SIM_TIME_MAX;
+static sim_time_t sim_tmr0_at = SIM_TIME_MAX;
+static double sim_lfintosc = 31000;     // Timer1(LFINTOSC)の周波数。t=0から数え始める
+static unsigned long sim_tmr1_overflows;
+static unsigned char sim_tmr1_latch;
+static sim_time_t sim_isr_start;
+static sim_time_t sim_edge_time;
+
+static sim_event_t *sim_events;
+static unsigned long sim_event_count;
+static unsigned long sim_event_pos;
+
+typedef struct {
+    sim_time_t      start;
+    sim_time_t      end;
+} sim_mark_t;
+
+static sim_mark_t *sim_marks;
+static unsigned long sim_mark_count;
+
+static sim_change_t *sim_changes;
+static unsigned long sim_change_count;
+
+static sim_stat_t sim_stats[DEBUG_SRC_MAX];
+
+// キーコードごとのメインループの動作(時間と電荷)
+typedef struct {
+    unsigned long   count;
+    sim_time_t      time;
+    double          charge;
+} sim_cmd_stat_t;
+
+static sim_cmd_stat_t sim_cmd_stats[KEYCODE_MAX];
+static const char *sim_key_name[KEYCODE_MAX] = {
+    "none", "off", "favorite", "nightlight", "minus", "plus", "all",
+};
+static const char *sim_cmd_name[CMD_LONGPUSH + 1] = {
+    "none", "off", "on", "longpush",
+};
+static int sim_verbose;
+static int sim_in_main;
+static int sim_main_level;
+static unsigned char sim_last_oscfrq = 0xFF;
+static int sim_last_led = -1;
+static int sim_last_sw = -1;
+
+static void *sim_grow(void *p, unsigned long count, size_t size)
+{
+    if( (count & (count - 1)) == 0 )
+    {
+        p = realloc(p, (count ? count * 2 : 64) * size);
+        if( p == NULL )
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    return p;
+}
+
+static void sim_record(sim_time_t t, char id, double value)
+{
+    if( sim_change_count >= SIM_CHANGES_MAX )
+        return;
+    sim_changes = sim_grow(sim_changes, sim_change_count, sizeof(*sim_changes));
+    sim_changes[sim_change_count].t = t;
+    sim_changes[sim_change_count].seq = sim_change_count;
+    sim_changes[sim_change_count].id = id;
+    sim_changes[sim_change_count].value = value;
+    sim_change_count++;
+}
+
+static double sim_fosc(void)
+{
+    static const double freq[] = { 1e6, 2e6, 4e6, 8e6, 12e6, 16e6, 32e6, 32e6 };
+    return freq[OSCFRQ & 0x07];
+}
+
+static sim_time_t sim_cycles_ns(double cycles)
+{
+    return (sim_time_t)(cycles * 4e9 / sim_fosc() + 0.5);
+}
+
+// 時刻tまで現在の状態で進める
+static void sim_advance(sim_time_t t)
+{
+    if( t <= sim_now )
+        return;
+    energy_account(sim_state, OSCFRQ & 0x07, NCO1CONbits.EN, t - sim_now);
+    sim_now = t;
+}
+
+// クロックとメインループの出力ピンの変化を記録する
+static void sim_poll(void)
+{
+    if( OSCFRQ != sim_last_oscfrq )
+    {
+        sim_last_oscfrq = OSCFRQ;
+        sim_record(sim_now, 'f', sim_fosc() / 1e6);
+    }
+    if( LED1 != sim_last_led )
+    {
+        sim_last_led = LED1;
+        sim_record(sim_now, 'l', sim_last_led);
+    }
+    if( PC_POWER_SW != sim_last_sw )
+    {
+        sim_last_sw = PC_POWER_SW;
+        sim_record(sim_now, 's', sim_last_sw);
+    }
+}
+
+static void sim_pin_pattern(debug_src_t src, int level)
+{
+    int n;
+
+    // debug_pin_exit(): Lパルスを番号の数だけ出してから戻す
+    for( n = src; n > 0; n-- )
+    {
+        sim_record(sim_now, 'd', 0);
+        sim_advance(sim_now + sim_cycles_ns(1));
+        sim_record(sim_now, 'd', 1);
+        sim_advance(sim_now + sim_cycles_ns(3));
+    }
+    sim_record(sim_now, 'd', level);
+}
+
+void sim_debug_enter(debug_src_t src)
+{
+    if( src == DEBUG_SRC_MAIN )
+    {
+        sim_main_level = 1;
+        sim_main_start = sim_now;
+    }
+    sim_poll();
+    sim_record(sim_now, 'd', 1);
+    sim_record(sim_now, '0' + src, 1);
+}
+
+void sim_debug_exit(debug_src_t src)
+{
+    sim_stat_t *st = &sim_stats[src];
+    sim_time_t start;
+    sim_time_t width;
+
+    sim_poll();
+    if( src == DEBUG_SRC_MAIN )
+    {
+        start = sim_main_start;
+        sim_main_level = 0;
+    }
+    else
+    {
+        start = sim_isr_start;
+        sim_advance(sim_now + sim_cycles_ns(sim_cycles[src]));
+    }
+    sim_pin_pattern(src, sim_main_level);
+    sim_record(sim_now, '0' + src, 0);
+
+    width = sim_now - start;
+    st->count++;
+    st->busy += width;
+    if( st->max < width )
+        st->max = width;
+}
+
+volatile unsigned char *sim_smt1stat(void)
+{
+    static unsigned char value;
+
+    value = 0;      // RST, CPRUP, CPWUPはすぐに完了する
+    return &value;
+}
+
+// TMR1Lの読み出しでTMR1Hをラッチする(RD16=1)。
+// 読み出しを繰り返して変化を待つループがあるので、1回の読み出しで命令数サイクル分の時間を進める
+volatile unsigned char *sim_tmr1l(void)
+{
+    static unsigned char value;
+    unsigned long count;
+
+    sim_advance(sim_now + sim_cycles_ns(4));
+    count = (unsigned long)(sim_now * 1e-9 * sim_lfintosc);
+
+    value = count & 0xFF;
+    sim_tmr1_latch = (count >> 8) & 0xFF;
+    return &value;
+}
+
+volatile unsigned char *sim_tmr1h(void)
+{
+    static unsigned char value;
+
+    value = sim_tmr1_latch;
+    return &value;
+}
+
+static sim_time_t sim_tmr1_at(void)
+{
+    if( T1CONbits.ON == 0 )
+        return SIM_TIME_MAX;
+    return (sim_time_t)((sim_tmr1_overflows + 1) * 65536.0 / sim_lfintosc * 1e9);
+}
+
+// Timer0(予約の校正): T0ENを1にしてから、TMR0の残りのカウント分のMFINTOSC(500kHz)でオーバーフローする。
+// T0ENの変化はレジスターの書き込みでは分からないので、次のイベントを探すときに調べる
+static sim_time_t sim_tmr0_next(void)
+{
+    if( T0CON0bits.T0EN == 0 )
+        sim_tmr0_at = SIM_TIME_MAX;
+    else if( sim_tmr0_at == SIM_TIME_MAX )
+        sim_tmr0_at = sim_now + (0x10000 - ((unsigned int)TMR0H << 8 | TMR0L)) * SIM_SMT_TICK_NS;
+    return sim_tmr0_at;
+}
+
+static sim_time_t sim_next_time(void)
+{
+    sim_time_t t = SIM_TIME_MAX;
+
+    if( sim_event_pos < sim_event_count )
+        t = sim_events[sim_event_pos].t;
+    if( sim_tmr4_at < t )
+        t = sim_tmr4_at;
+    if( sim_tmr1_at() < t )
+        t = sim_tmr1_at();
+    if( sim_tmr0_next() < t )
+        t = sim_tmr0_next();
+    return t;
+}
+
+static void sim_isr(void (*isr)(void), debug_src_t src, sim_time_t t)
+{
+    sim_time_t latency;
+    unsigned int smt;
+    sim_state_t state = sim_state;
+
+    // 他の割り込み処理やメインループの動作中でも、割り込みは処理の終了後(メインループは中断)に実行する
+    sim_advance(t);
+    sim_state = SIM_STATE_ISR;
+    sim_advance(sim_now + sim_cycles_ns(sim_cycles[DEBUG_SRC_NONE]));
+    sim_isr_start = sim_now;
+    latency = sim_now - t;
+
+    // SMT1TMRはエッジからの経過時間(clock_fast()で遅延の測定に使う)
+    smt = (unsigned int)((sim_now - sim_edge_time) / SIM_SMT_TICK_NS);
+    SMT1TMRL = smt & 0xFF;
+    SMT1TMRH = smt >> 8;
+
+    if( sim_stats[src].count == 0 || latency < sim_stats[src].latency_min )
+        sim_stats[src].latency_min = latency;
+    if( sim_stats[src].latency_max < latency )
+        sim_stats[src].latency_max = latency;
+
+    isr();
+    sim_poll();
+    sim_state = state;
+}
+
+// 時刻limitまでのイベントを1つ処理する
+static int sim_step(sim_time_t limit)
+{
+    sim_time_t t = sim_next_time();
+    sim_event_t *ev;
+    unsigned int ticks;
+
+    if( t == SIM_TIME_MAX || t > limit )
+        return 0;
+
+    if( sim_tmr4_at == t )
+    {
+        sim_tmr4_at = SIM_TIME_MAX;
+        T4CONbits.ON = 0;       // ワンショット
+        TMR4IF = 1;
+        sim_isr(ir_receiver_tmr_isr, DEBUG_SRC_TIMEOUT, t);
+        return 1;
+    }
+    if( sim_tmr1_at() == t )
+    {
+        sim_tmr1_overflows++;
+        TMR1IF = 1;
+        sim_isr(power_timer_isr, DEBUG_SRC_TIMER, t);
+        return 1;
+    }
+    if( sim_tmr0_at == t )
+    {
+        sim_tmr0_at = SIM_TIME_MAX;
+        TMR0IF = 1;
+        sim_isr(power_timer_cal_isr, DEBUG_SRC_TIMER, t);
+        return 1;
+    }
+
+    ev = &sim_events[sim_event_pos++];
+    ticks = (unsigned int)(ev->arg / SIM_SMT_TICK_NS);
+    switch( ev->kind )
+    {
+        case SIM_EV_PWA:
+            sim_edge_time = ev->t;
+            SMT1CPWH = ticks >> 8;
+            SMT1CPWL = ticks & 0xFF;
+            SMT1PWAIF = 1;
+            sim_isr(ir_receiver_pwa_isr, DEBUG_SRC_PWA, ev->t);
+            break;
+
+        case SIM_EV_PRA:
+            sim_edge_time = ev->t;
+            SMT1CPRH = ticks >> 8;
+            SMT1CPRL = ticks & 0xFF;
+            SMT1PRAIF = 1;
+            sim_isr(ir_receiver_pra_isr, DEBUG_SRC_PRA, ev->t);
+            break;
+
+        case SIM_EV_FRAME:
+            SMT1IF = 1;
+            sim_isr(ir_receiver_isr, DEBUG_SRC_FRAME, ev->t);
+            // ir_receiver_isr()でTMR4を再起動している
+            sim_tmr4_at = sim_now + ((sim_time_t)T4PR + 1) * SIM_TMR4_TICK_NS;
+            break;
+
+        case SIM_EV_POWER:
+            sim_advance(ev->t);
+            if( PORTCbits.RC0 != (ev->arg ? 0 : 1) )
+            {
+                PORTCbits.RC0 = ev->arg ? 0 : 1;    // 電源LEDは負論理
+                sim_record(ev->t, 'p', ev->arg);
+#ifdef POWER_STATS_ENABLE
+                if( PIE0bits.IOCIE && (PORTCbits.RC0 ? IOCCPbits.IOCCP0 : IOCCNbits.IOCCN0) )
+                {
+                    IOCCFbits.IOCCF0 = 1;
+                    sim_isr(power_stats_ioc_isr, DEBUG_SRC_LED, ev->t);
+                }
+#endif
+            }
+            break;
+    }
+    return 1;
+}
+
+// __delay_ms/__delay_us: _XTAL_FREQでの命令数を現在のクロックで実行し、その間の割り込みも処理する
+void sim_delay_us(double us)
+{
+    double cycles = us * (_XTAL_FREQ / 4e6);
+    sim_time_t t;
+    sim_time_t end;
+
+    sim_poll();
+    while( 1 )
+    {
+        t = sim_next_time();
+        end = sim_now + sim_cycles_ns(cycles);
+        if( t == SIM_TIME_MAX || end <= t )
+        {
+            sim_advance(end);
+            break;
+        }
+        if( sim_now < t )
+        {
+            cycles -= (double)(t - sim_now) * sim_fosc() / 4e9;
+            sim_advance(t);
+        }
+        sim_step(t);
+    }
+    sim_poll();
+}
+
+static void sim_add_event(sim_time_t t, sim_ev_kind_t kind, unsigned long arg)
+{
+    sim_events = sim_grow(sim_events, sim_event_count, sizeof(*sim_events));
+    sim_events[sim_event_count].t = t;
+    sim_events[sim_event_count].kind = kind;
+    sim_events[sim_event_count].arg = arg;
+    sim_event_count++;
+}
+
+static void sim_add_mark(sim_time_t *t, sim_time_t mark, sim_time_t space)
+{
+    sim_marks = sim_grow(sim_marks, sim_mark_count, sizeof(*sim_marks));
+    sim_marks[sim_mark_count].start = *t;
+    sim_marks[sim_mark_count].end = *t + mark;
+    sim_mark_count++;
+    *t += mark + space;
+}
+
+// パルス距離変調のフレーム(NEC, 家製協)
+static sim_time_t sim_add_frame(sim_time_t t, irr_type_t type, const unsigned char *data, int length)
+{
+    double unit = (type == IRR_TYPE_NEC) ? T_NEC : T_AEHA;
+    sim_time_t tu = (sim_time_t)(unit * 1e9);
+    int i, b;
+
+    sim_add_mark(&t, tu * ((type == IRR_TYPE_NEC) ? 16 : 8), tu * ((type == IRR_TYPE_NEC) ? 8 : 4));
+    for( i = 0; i < length; i++ )
+    {
+        for( b = 0; b < 8; b++ )
+        {
+            sim_add_mark(&t, tu, ((data[i] >> b) & 1) ? tu * 3 : tu);
+        }
+    }
+    sim_add_mark(&t, tu, 0);
+    return t;
+}
+
+static void sim_parse_line(char *line, int lineno)
+{
+    char *p;
+    char *tok;
+    double ms;
+    sim_time_t t;
+    unsigned char data[IRT_DATA_MAX];
+    int length = 0;
+    int count = 1;
+    irr_type_t type;
+    sim_time_t start, end;
+
+    if( (p = strchr(line, '#')) != NULL )
+        *p = '\0';
+    if( (tok = strtok(line, " \t\r\n")) == NULL )
+        return;
+    ms = strtod(tok, &p);
+    if( *p != '\0' || (tok = strtok(NULL, " \t\r\n")) == NULL )
+    {
+        fprintf(stderr, "line %d: syntax error\n", lineno);
+        exit(1);
+    }
+    t = (sim_time_t)(ms * 1e6);
+
+    if( strcmp(tok, "nec") == 0 || strcmp(tok, "aeha") == 0 )
+    {
+        type = (tok[0] == 'n') ? IRR_TYPE_NEC : IRR_TYPE_AEHA;
+        while( (tok = strtok(NULL, " \t\r\n")) != NULL )
+        {
+            if( tok[0] == 'x' )
+                count = atoi(tok + 1);
+            else if( length < IRT_DATA_MAX )
+                data[length++] = (unsigned char)strtoul(tok, NULL, 16);
+        }
+        if( length == 0 || (type == IRR_TYPE_NEC && length != 4) )
+        {
+            fprintf(stderr, "line %d: bad frame\n", lineno);
+            exit(1);
+        }
+        for( ; count > 0; count-- )
+        {
+            start = t;
+            end = sim_add_frame(t, type, data, length);
+            t = (end - start + SIM_FRAME_GAP > SIM_FRAME_PERIOD) ? end + SIM_FRAME_GAP : start + SIM_FRAME_PERIOD;
+        }
+        if( sim_end < t )
+            sim_end = t;
+    }
+    else if( strcmp(tok, "power") == 0 )
+    {
+        tok = strtok(NULL, " \t\r\n");
+        sim_add_event(t, SIM_EV_POWER, tok != NULL && strcmp(tok, "on") == 0);
+    }
+    else if( strcmp(tok, "end") == 0 )
+    {
+        sim_end = t;
+    }
+    else
+    {
+        fprintf(stderr, "line %d: unknown command '%s'\n", lineno, tok);
+        exit(1);
+    }
+}
+
+static const char *sim_default_scenario[] = {
+    "100 nec 82 6d a6 59     # 全灯: 電源オン",
+    "2000 power on",
+    "3000 nec 82 6d be 41 x2 # OFF: 電源オフ(2フレームで確定)",
+    "5000 power off",
+    "6000 nec 82 6d bd 42 x3 # お気に入り: 確認音のみ",
+};
+
+// 1日の利用を想定した合成プロファイル(朝に電源オン、夜に予約で電源オフ、夕方以降はほかのリモコンの信号)
+static void sim_profile(double hours)
+{
+    static const char *daily[] = {
+        "%.0f nec 82 6d a6 59",         // 7:00 全灯: 電源オン
+        "%.0f power on",
+        "%.0f nec 82 6d bd 42 x2",      // 12:30 お気に入り
+        "%.0f nec 82 6d ba 45",         // 18:00 +: 電源オフの予約
+        "%.0f nec 82 6d bb 44",         // 18:01 -: 予約の取り消し
+        "%.0f nec 82 6d ba 45",         // 22:30 +: 23:00に電源オフ(Timer1)
+        "%.0f power off",
+    };
+    static const double daily_ms[] = {
+        7 * 3600e3, 7 * 3600e3 + 2000, 12.5 * 3600e3, 18 * 3600e3, 18 * 3600e3 + 60e3, 22.5 * 3600e3, 23 * 3600e3 + 5000,
+    };
+    char line[256];
+    double day, t;
+    unsigned long seed = 1;
+    int i, lineno = 0;
+
+    for( day = 0; day * 24 < hours; day++ )
+    {
+        for( i = 0; i < (int)(sizeof(daily) / sizeof(daily[0])); i++ )
+        {
+            t = day * 24 * 3600e3 + daily_ms[i];
+            if( t >= hours * 3600e3 )
+                continue;
+            snprintf(line, sizeof(line), daily[i], t);
+            sim_parse_line(line, ++lineno);
+        }
+        // 17:00〜23:00 テレビのリモコン(平均3分ごと)、8:00/13:00/20:00 エアコンのリモコン(家製協)
+        for( t = day * 24 * 3600e3 + 17 * 3600e3; t < day * 24 * 3600e3 + 23 * 3600e3; )
+        {
+            seed = seed * 1103515245 + 12345;
+            t += 60e3 + (double)((seed >> 16) % 240) * 1e3;
+            if( t >= hours * 3600e3 )
+                break;
+            snprintf(line, sizeof(line), "%.0f nec 40 bf 12 ed x2", t);
+            sim_parse_line(line, ++lineno);
+        }
+        for( i = 0; i < 3; i++ )
+        {
+            t = day * 24 * 3600e3 + (8 + i * 6) * 3600e3 - 1800e3 + (i * 7919 % 600) * 1e3;
+            if( t >= hours * 3600e3 )
+                continue;
+            snprintf(line, sizeof(line), "%.0f aeha 23 cb 26 01 00 20", t);
+            sim_parse_line(line, ++lineno);
+        }
+    }
+    sim_end = (sim_time_t)(hours * 3600e9);
+}
+
+static int sim_event_cmp(const void *a, const void *b)
+{
+    const sim_event_t *ea = a, *eb = b;
+
+    if( ea->t != eb->t )
+        return ea->t < eb->t ? -1 : 1;
+    return (int)ea->kind - (int)eb->kind;
+}
+
+static int sim_change_cmp(const void *a, const void *b)
+{
+    const sim_change_t *ca = a, *cb = b;
+
+    if( ca->t != cb->t )
+        return ca->t < cb->t ? -1 : 1;
+    return ca->seq < cb->seq ? -1 : 1;
+}
+
+static int sim_mark_cmp(const void *a, const void *b)
+{
+    const sim_mark_t *ma = a, *mb = b;
+
+    return ma->start < mb->start ? -1 : (ma->start > mb->start);
+}
+
+// 赤外線の波形からSMT1の割り込みを作る(初期化後のSMT1PRを使う)
+static void sim_build_edges(void)
+{
+    sim_time_t timeout = ((sim_time_t)SMT1PRH << 8 | SMT1PRL) * SIM_SMT_TICK_NS;
+    unsigned long i;
+    sim_time_t gap;
+
+    qsort(sim_marks, sim_mark_count, sizeof(*sim_marks), sim_mark_cmp);
+    for( i = 0; i < sim_mark_count; i++ )
+    {
+        sim_record(sim_marks[i].start, 'i', 1);
+        sim_record(sim_marks[i].end, 'i', 0);
+        if( i > 0 )
+        {
+            gap = sim_marks[i].start - sim_marks[i - 1].end;
+            if( gap < timeout )
+                sim_add_event(sim_marks[i].start, SIM_EV_PRA, gap);
+        }
+        sim_add_event(sim_marks[i].end, SIM_EV_PWA, sim_marks[i].end - sim_marks[i].start);
+        if( i + 1 == sim_mark_count || sim_marks[i + 1].start - sim_marks[i].end >= timeout )
+            sim_add_event(sim_marks[i].end + timeout, SIM_EV_FRAME, 0);
+    }
+    qsort(sim_events, sim_event_count, sizeof(*sim_events), sim_event_cmp);
+}
+
+static void sim_write_vcd(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    unsigned long i;
+    sim_time_t last = SIM_TIME_MAX;
+    int src;
+
+    if( fp == NULL )
+    {
+        perror(path);
+        exit(1);
+    }
+    qsort(sim_changes, sim_change_count, sizeof(*sim_changes), sim_change_cmp);
+
+    fprintf(fp, "$timescale 1ns $end\n$scope module pcremocon $end\n");
+    fprintf(fp, "$var wire 1 i ir $end\n");
+    fprintf(fp, "$var wire 1 d debug_pin $end\n");
+    for( src = DEBUG_SRC_PWA; src < DEBUG_SRC_MAX; src++ )
+        fprintf(fp, "$var wire 1 %c %s $end\n", '0' + src, sim_src_name[src]);
+    fprintf(fp, "$var wire 1 l led $end\n");
+    fprintf(fp, "$var wire 1 s pwr_sw $end\n");
+    fprintf(fp, "$var wire 1 p pwr_led $end\n");
+    fprintf(fp, "$var real 64 f fosc_mhz $end\n");
+    fprintf(fp, "$upscope $end\n$enddefinitions $end\n");
+    fprintf(fp, "#0\n$dumpvars\n0i\n0d\n");
+    for( src = DEBUG_SRC_PWA; src < DEBUG_SRC_MAX; src++ )
+        fprintf(fp, "0%c\n", '0' + src);
+    fprintf(fp, "0l\n0s\n0p\nr32 f\n$end\n");
+
+    for( i = 0; i < sim_change_count; i++ )
+    {
+        if( sim_changes[i].t != last )
+        {
+            last = sim_changes[i].t;
+            fprintf(fp, "#%llu\n", last);
+        }
+        if( sim_changes[i].id == 'f' )
+            fprintf(fp, "r%g f\n", sim_changes[i].value);
+        else
+            fprintf(fp, "%d%c\n", sim_changes[i].value != 0, sim_changes[i].id);
+    }
+    fclose(fp);
+}
+
+static void sim_report(void)
+{
+    int src;
+    sim_stat_t *st;
+#ifdef POWER_STATS_ENABLE
+    pcremocon_cmd_t cmd;
+    const unsigned char *hist;
+#endif
+
+    printf("%-8s %8s %12s %10s %10s %10s %10s\n", "src", "count", "busy(us)", "max(us)", "avg(us)", "lat.min", "lat.max");
+    for( src = DEBUG_SRC_PWA; src < DEBUG_SRC_MAX; src++ )
+    {
+        st = &sim_stats[src];
+        if( st->count == 0 )
+            continue;
+        printf("%-8s %8lu %12.1f %10.1f %10.1f", sim_src_name[src], st->count,
+            st->busy / 1e3, st->max / 1e3, st->busy / 1e3 / st->count);
+        if( src != DEBUG_SRC_MAIN )
+            printf(" %10.1f %10.1f", st->latency_min / 1e3, st->latency_max / 1e3);
+        printf("\n");
+    }
+    printf("\n%-12s %8s %12s %14s\n", "keycode", "count", "avg(ms)", "avg(uC)");
+    for( src = 0; src < KEYCODE_MAX; src++ )
+    {
+        if( sim_cmd_stats[src].count == 0 )
+            continue;
+        printf("%-12s %8lu %12.1f %14.3f\n", sim_key_name[src], sim_cmd_stats[src].count,
+            sim_cmd_stats[src].time / 1e6 / sim_cmd_stats[src].count,
+            sim_cmd_stats[src].charge * 1e6 / sim_cmd_stats[src].count);
+    }
+    printf("\nframes=%u keys=%u errors=%u\n", irr_stats.frames, irr_stats.keys, irr_stats.errors);
+    printf("clock: switch_ups=%u latency_last=%uus latency_max=%uus\n",
+        clock_stats.switch_ups, clock_stats.latency_last * 2, clock_stats.latency_max * 2);
+#ifdef POWER_STATS_ENABLE
+    printf("\n%-12s %6s %6s %6s %6s %6s %6s %6s %6s %6s %6s\n", "power",
+        "<0.5s", "<1s", "<2s", "<4s", "<8s", "<16s", "<32s", "<64s", ">=64s", "none");
+    for( cmd = CMD_OFF; cmd <= CMD_LONGPUSH; cmd++ )
+    {
+        hist = power_stats_get(cmd);
+        printf("%-12s", sim_cmd_name[cmd]);
+        for( src = 0; src < POWER_STATS_BUCKETS; src++ )
+            printf(" %6u", hist[src]);
+        printf("\n");
+    }
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    const char *vcd = NULL;
+    double hours = 0;
+    const char *scenario = NULL;
+    char line[256];
+    FILE *fp;
+    int lineno = 0;
+    int i, src;
+    char *eq;
+    keycode_t key;
+    sim_time_t start;
+    double charge;
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp(argv[i], "-o") == 0 && i + 1 < argc )
+        {
+            vcd = argv[++i];
+        }
+        else if( strcmp(argv[i], "-p") == 0 && i + 1 < argc )
+        {
+            hours = atof(argv[++i]);
+        }
+        else if( strcmp(argv[i], "-v") == 0 )
+        {
+            sim_verbose = 1;
+        }
+        else if( strcmp(argv[i], "-l") == 0 && i + 1 < argc )
+        {
+            sim_lfintosc = atof(argv[++i]);
+            if( sim_lfintosc <= 0 )
+                goto usage;
+        }
+        else if( strcmp(argv[i], "-c") == 0 && i + 1 < argc )
+        {
+            i++;
+            if( (eq = strchr(argv[i], '=')) == NULL )
+                goto usage;
+            for( src = 0; src < DEBUG_SRC_MAX; src++ )
+            {
+                if( strncmp(argv[i], sim_src_name[src], eq - argv[i]) == 0 && sim_src_name[src][eq - argv[i]] == '\0' )
+                    break;
+            }
+            if( src == DEBUG_SRC_MAX )
+                goto usage;
+            sim_cycles[src] = strtoul(eq + 1, NULL, 0);
+        }
+        else if( argv[i][0] == '-' || scenario != NULL )
+        {
+            goto usage;
+        }
+        else
+        {
+            scenario = argv[i];
+        }
+    }
+
+    if( hours > 0 )
+    {
+        sim_profile(hours);
+    }
+    else if( scenario != NULL )
+    {
+        if( (fp = fopen(scenario, "r")) == NULL )
+        {
+            perror(scenario);
+            return 1;
+        }
+        while( fgets(line, sizeof(line), fp) != NULL )
+            sim_parse_line(line, ++lineno);
+        fclose(fp);
+    }
+    else
+    {
+        for( i = 0; i < (int)(sizeof(sim_default_scenario) / sizeof(sim_default_scenario[0])); i++ )
+        {
+            strncpy(line, sim_default_scenario[i], sizeof(line) - 1);
+            line[sizeof(line) - 1] = '\0';
+            sim_parse_line(line, i + 1);
+        }
+    }
+    if( hours <= 0 )
+        sim_end += 1000000000ULL;  // 最後のフレームの後、リピートのタイムアウトと動作の終了まで
+
+    // リセット直後の状態
+    OSCFRQ = CLOCK_FAST_HFFRQ;
+    OSCSTATbits.HFOR = 1;
+    TX1STAbits.TRMT = 1;        // UARTの信号はシミュレートしないので、常に送受信していない
+    BAUD1CONbits.RCIDL = 1;
+    PORTCbits.RC0 = 1;
+#ifdef CLOCK_IDLE_ENABLE
+    energy_set_idle(1);
+#endif
+    init();
+    sim_poll();
+    sim_build_edges();
+
+    while( sim_step(sim_end) )
+    {
+        if( COMMON.received != 0 && sim_in_main == 0 )
+        {
+            key = COMMON.keycode;
+            start = sim_now;
+            charge = energy_charge();
+            if( sim_verbose != 0 )
+                printf("%12.3fms keycode=%s command=%d\n", sim_now / 1e6, sim_key_name[key], COMMON.command);
+            sim_in_main = 1;
+            sim_state = SIM_STATE_MAIN;
+            main_task();
+            sim_state = SIM_STATE_IDLE;
+            sim_in_main = 0;
+            sim_cmd_stats[key].count++;
+            sim_cmd_stats[key].time += sim_now - start;
+            sim_cmd_stats[key].charge += energy_charge() - charge;
+        }
+        else
+        {
+            // 割り込みでIDLEから戻るたびのポーリング(power_stats_pollなど)。時間は数えない
+            main_task();
+        }
+    }
+    sim_advance(sim_end);
+    sim_poll();
+
+    if( vcd != NULL )
+        sim_write_vcd(vcd);
+    sim_report();
+    energy_report(sim_now);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-o out.vcd] [-v] [-l hz] [-c src=cycles]... [-p hours | scenario]\n", argv[0]);
+    return 1;
+}
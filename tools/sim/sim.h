@@ -0,0 +1,47 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+// ホストシミュレーター(sim.c)とエネルギーモデル(energy.c)の共通定義
+
+#ifndef _IR_REMOCON_ANALYZER_SIM_H_
+#define _IR_REMOCON_ANALYZER_SIM_H_
+
+typedef unsigned long long sim_time_t;      // ns
+
+// CPUの状態
+typedef enum {
+    SIM_STATE_IDLE = 0,     // メインループの待機(ビジーウェイトまたはIDLE)
+    SIM_STATE_ISR,          // 割り込み処理
+    SIM_STATE_MAIN,         // メインループの動作(__delay_msを含む)
+    SIM_STATE_MAX
+} sim_state_t;
+
+#define SIM_HFFRQ_MAX       7       // OSCFRQのHFFRQ(000〜110)
+
+void energy_set_idle(int idle);     // 待機中のCPU(0=ビジーウェイト, 1=IDLE)
+void energy_account(sim_state_t state, unsigned char hffrq, int nco, sim_time_t ns);
+double energy_charge(void);         // 累積の電荷(C)
+void energy_report(sim_time_t total);
+
+#endif // _IR_REMOCON_ANALYZER_SIM_H_
@@ -0,0 +1,75 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+// ホストシミュレーター用のHEF(hef.cの代わりにリンクする)。起動時は消去済み
+
+#include "hef.h"
+
+static unsigned int sim_hef[HEF_ROW_SIZE * HEF_ROWS];
+static unsigned char sim_hef_ready;
+
+static void sim_hef_init(void)
+{
+    unsigned int i;
+
+    if( sim_hef_ready != 0 )
+        return;
+    for( i = 0; i < HEF_ROW_SIZE * HEF_ROWS; i++ )
+        sim_hef[i] = HEF_ERASED;
+    sim_hef_ready = 1;
+}
+
+unsigned int hef_read(unsigned int addr)
+{
+    sim_hef_init();
+    return sim_hef[addr - HEF_ADDR];
+}
+
+void hef_erase_row(unsigned int addr)
+{
+    unsigned int i;
+    unsigned int row = (addr - HEF_ADDR) & ~(HEF_ROW_SIZE - 1);
+
+    sim_hef_init();
+    for( i = 0; i < HEF_ROW_SIZE; i++ )
+        sim_hef[row + i] = HEF_ERASED;
+}
+
+void hef_write(unsigned int addr, const unsigned int *data, unsigned char count)
+{
+    unsigned char i;
+
+    sim_hef_init();
+    for( i = 0; i < count; i++ )
+        sim_hef[addr - HEF_ADDR + i] &= data[i];    // 書き込みは1->0のみ
+}
+
+void hef_write_bytes(unsigned int addr, const unsigned char *data, unsigned char count)
+{
+    unsigned char i;
+
+    sim_hef_init();
+    for( i = 0; i < count; i++ )
+        sim_hef[addr - HEF_ADDR + i] &= data[i];
+}
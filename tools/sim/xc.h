@@ -0,0 +1,46 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+// ホストシミュレーター用のxc.h(ファームウェアのソースをgccでビルドするための代用)
+
+#ifndef _IR_REMOCON_ANALYZER_SIM_XC_H_
+#define _IR_REMOCON_ANALYZER_SIM_XC_H_
+
+#include "pic16f18424.h"
+
+#define __interrupt(x)
+#define __flags(...)
+#define di()            ((void)0)
+#define ei()            ((void)0)
+#define NOP()           ((void)0)
+#define SLEEP()         ((void)0)
+#define RESET()         ((void)0)
+#define CLRWDT()        ((void)0)
+
+// __delay_ms/__delay_usは_XTAL_FREQを前提とした命令数のループなので、シミュレーターで現在のクロックから時間を進める
+void sim_delay_us(double us);
+#define __delay_ms(x)   sim_delay_us((x) * 1000.0)
+#define __delay_us(x)   sim_delay_us(x)
+
+#endif // _IR_REMOCON_ANALYZER_SIM_XC_H_
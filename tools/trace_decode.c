@@ -0,0 +1,179 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+    トレースバッファ(trace_buffer)のダンプを時系列に変換する
+
+    ビルド: cc -o trace_decode trace_decode.c
+    使い方: trace_decode [-b] <dumpfile>
+        dumpfile はMPLABのメモリビュー等でコピーした trace_buffer の16進ダンプ
+        (2桁の16進数以外のトークンは無視する)。-b 指定時はバイナリとして読む
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define TRACE_TICK_HZ       968.75      // trace.h と合わせる
+#define SMT_TICK_US         2.0         // 64us単位の幅の換算用
+#define RECORD_SIZE         4           // time(2), event(1), arg(1)
+#define MAX_BYTES           4096
+
+static const char *kind_names[16] = {
+    [0x1] = "EDGE_H", [0x2] = "EDGE_L", [0x3] = "STATE", [0x4] = "ERROR",
+    [0x5] = "KEYCODE", [0x6] = "CMD", [0x7] = "PWR_LED", [0x8] = "TIMEOUT",
+};
+static const char *edge_names[] = {
+    "OTHER", "LEADER", "DATA", "DATA0", "DATA1", "TRAILER", "BAD",
+};
+static const char *state_names[] = {
+    "IDLE", "LEADER", "DATA",
+};
+static const char *error_names[] = {
+    "NONE", "STATE_H", "STATE_L", "LEADER_H", "LEADER_L",
+    "DATA_H", "DATA_L", "DATA_CHECK", "DATA_OVERRUN", "DATA_PHASE",
+};
+static const char *keycode_names[] = {
+    "NONE", "OFF", "FAVORITE", "NIGHTLIGHT", "MINUS", "PLUS", "ALL",
+};
+static const char *cmd_names[] = {
+    "NONE", "OFF", "ON", "LONGPUSH",
+};
+
+#define NAME(TBL, I) ((unsigned)(I) < sizeof(TBL) / sizeof(TBL[0]) && TBL[I] ? TBL[I] : "?")
+
+static int read_hex(FILE *fp, unsigned char *buf, int max)
+{
+    char tok[64];
+    int n = 0;
+
+    while( n < max && fscanf(fp, "%63s", tok) == 1 )
+    {
+        if( strlen(tok) == 2 && isxdigit((unsigned char)tok[0]) && isxdigit((unsigned char)tok[1]) )
+        {
+            buf[n++] = (unsigned char)strtoul(tok, NULL, 16);
+        }
+    }
+    return n;
+}
+
+static void print_event(unsigned char event, unsigned char arg)
+{
+    unsigned kind = event >> 4;
+    unsigned detail = event & 0x0F;
+
+    printf("%-8s ", NAME(kind_names, kind));
+    switch( kind )
+    {
+        case 0x1:
+        case 0x2:
+            printf("%-8s %6.2fms", NAME(edge_names, detail), arg * 32 * SMT_TICK_US / 1000.0);
+            if( arg == 255 )
+                printf("+");
+            break;
+        case 0x3:
+            printf("%s", NAME(state_names, detail));
+            break;
+        case 0x4:
+            printf("%s", NAME(error_names, detail));
+            break;
+        case 0x5:
+            printf("%-8s data[2]=%02x", NAME(keycode_names, detail), arg);
+            break;
+        case 0x6:
+            printf("%-8s key=%s", NAME(cmd_names, detail), NAME(keycode_names, arg));
+            break;
+        case 0x7:
+            printf("%s", detail == 0 ? "ON" : "OFF");   // PC_POWER_LED_N は負論理
+            break;
+        default:
+            break;
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static unsigned char buf[MAX_BYTES];
+    const char *path = NULL;
+    int binary = 0;
+    int n, count, pos, i;
+    long elapsed = 0;
+    unsigned int prev = 0;
+    int first = 1;
+    FILE *fp;
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp(argv[i], "-b") == 0 )
+            binary = 1;
+        else
+            path = argv[i];
+    }
+    if( path == NULL )
+    {
+        fprintf(stderr, "usage: %s [-b] <dumpfile>\n", argv[0]);
+        return 1;
+    }
+
+    fp = fopen(path, binary ? "rb" : "r");
+    if( fp == NULL )
+    {
+        perror(path);
+        return 1;
+    }
+    n = binary ? (int)fread(buf, 1, sizeof(buf), fp) : read_hex(fp, buf, sizeof(buf));
+    fclose(fp);
+
+    // 先頭1バイトが書き込み位置、以降4バイトずつのレコード(リトルエンディアン)
+    count = (n - 1) / RECORD_SIZE;
+    if( count <= 0 || (count & (count - 1)) != 0 )
+    {
+        fprintf(stderr, "unexpected dump size: %d bytes\n", n);
+        return 1;
+    }
+    pos = buf[0] & (count - 1);
+
+    printf("%10s %10s  event\n", "time[ms]", "delta[ms]");
+    for( i = 0; i < count; i++ )
+    {
+        const unsigned char *r = &buf[1 + ((pos + i) & (count - 1)) * RECORD_SIZE];
+        unsigned int time = r[0] | (r[1] << 8);
+        unsigned int delta;
+
+        if( r[2] == 0 )
+            continue;   // 未使用
+
+        // タイマーは約67秒で一周するので、記録間隔はそれ未満とみなす
+        delta = first ? 0 : (unsigned int)(time - prev) & 0xFFFF;
+        elapsed += delta;
+        prev = time;
+        first = 0;
+
+        printf("%10.1f %+10.1f  ", elapsed * 1000.0 / TRACE_TICK_HZ, delta * 1000.0 / TRACE_TICK_HZ);
+        print_event(r[2], r[3]);
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "power_timer.h"
+#include "trace.h"
+
+#ifdef TRACE_ENABLE
+trace_buffer_t trace_buffer;
+#endif
+
+void trace_init(void)
+{
+#ifdef TRACE_ENABLE
+    c_memzero(&trace_buffer, sizeof(trace_buffer));
+
+#ifndef POWER_TIMER_ENABLE
+    T0CON1 = 0x95;      // T0CS=100 ... LFINTOSC, T0ASYNC=1, T0CKPS=0101 ... 1:32
+    TMR0H = 0x00;
+    TMR0L = 0x00;
+    T0CON0 = 0x90;      // T0EN=1, (0), (0), T0MD16=1, T0OUTPS=0000 ... 1:1
+#endif
+#endif
+}
+
+#ifdef TRACE_ENABLE
+void trace_put(unsigned char event, unsigned char arg)
+{
+    trace_record_t *r = &trace_buffer.record[trace_buffer.pos];
+
+#ifdef POWER_TIMER_ENABLE
+    // Timer0は予約の校正に使うので、同じLFINTOSCで動作するTimer1の時刻を1/32にして使う
+    r->time = power_timer_trace_time();
+#else
+    r->time = TMR0L;                // TMR0Lの読み出しでTMR0Hがラッチされる
+    r->time |= (unsigned int)TMR0H << 8;
+#endif
+    r->event = event;
+    r->arg = arg;
+    trace_buffer.pos = (trace_buffer.pos + 1) & (TRACE_LEN - 1);
+}
+#endif  // TRACE_ENABLE
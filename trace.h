@@ -0,0 +1,90 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_TRACE_H_
+#define _IR_REMOCON_ANALYZER_TRACE_H_
+
+//#define TRACE_ENABLE      // フライトレコーダー(トレースバッファ)を有効にする
+//#define TRACE_DATA_EDGES  // データビットのエッジも記録する(1フレームでバッファが埋まるので注意)
+
+#define TRACE_LEN           32          // 記録数(2のべき乗で指定)
+#define TRACE_TICK_HZ       968.75      // LFINTOSC(31kHz) / 32
+
+// イベントは上位4bitが種別、下位4bitが詳細
+#define TRACE_KIND_MASK     0xF0
+#define TRACE_KIND_EDGE_H   0x10        // 詳細: trace_edge_t, 引数: H幅(64us単位)
+#define TRACE_KIND_EDGE_L   0x20        // 詳細: trace_edge_t, 引数: L幅(64us単位)
+#define TRACE_KIND_STATE    0x30        // 詳細: irr_state_t
+#define TRACE_KIND_ERROR    0x40        // 詳細: irr_error_t
+#define TRACE_KIND_KEYCODE  0x50        // 詳細: keycode_t
+#define TRACE_KIND_CMD      0x60        // 詳細: pcremocon_cmd_t, 引数: keycode_t
+#define TRACE_KIND_PWR_LED  0x70        // 詳細: PC_POWER_LED_N
+#define TRACE_KIND_TIMEOUT  0x80        // リピートの終了
+
+typedef enum {
+    TRACE_EDGE_OTHER = 0,   // 判定なし
+    TRACE_EDGE_LEADER,
+    TRACE_EDGE_DATA,        // データのH期間
+    TRACE_EDGE_DATA0,
+    TRACE_EDGE_DATA1,
+    TRACE_EDGE_TRAILER,
+    TRACE_EDGE_BAD,
+} trace_edge_t;
+
+typedef struct {
+    unsigned int    time;       // TRACE_TICK_HZ単位(約67秒で一周)
+    unsigned char   event;
+    unsigned char   arg;
+} trace_record_t;
+
+typedef struct {
+    unsigned char   pos;        // 次の書き込み位置
+    trace_record_t  record[TRACE_LEN];
+} trace_buffer_t;
+
+extern trace_buffer_t trace_buffer;
+
+void trace_init(void);
+void trace_put(unsigned char event, unsigned char arg);
+
+#define TRACE_WIDTH(W)  ((W) >= (256 << 5) ? 255 : (unsigned char)((W) >> 5))  // SMTカウント(2us) -> 64us単位
+
+#ifdef TRACE_ENABLE
+// 割り込み処理内から使用する
+#define TRACE(EV, ARG)      trace_put((EV), (ARG))
+// メインループから使用する
+#define TRACE_MAIN(EV, ARG) do { di(); trace_put((EV), (ARG)); ei(); } while(0)
+// SMTのエッジ判定結果(データビットはTRACE_DATA_EDGES指定時のみ)
+#ifdef TRACE_DATA_EDGES
+#define TRACE_EDGE(K, E, W) trace_put((K) | (E), TRACE_WIDTH(W))
+#else
+#define TRACE_EDGE(K, E, W) do { if( (E) != TRACE_EDGE_DATA && (E) != TRACE_EDGE_DATA0 && (E) != TRACE_EDGE_DATA1 ) trace_put((K) | (E), TRACE_WIDTH(W)); } while(0)
+#endif
+#else
+#define TRACE(EV, ARG)
+#define TRACE_MAIN(EV, ARG)
+#define TRACE_EDGE(K, E, W) ((void)(E))
+#endif
+
+#endif // _IR_REMOCON_ANALYZER_TRACE_H_
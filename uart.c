@@ -0,0 +1,458 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "common.h"
+#include "main.h"
+#include "clock.h"
+#include "ir_receiver.h"
+#include "ir_transmitter.h"
+#include "power_stats.h"
+#include "settings.h"
+#include "uart.h"
+
+#ifdef UART_ENABLE
+
+#define UART_CAPTURE_LEN    (sizeof(irr_capture_info_t) + 1 + UART_CAPTURE_READ_MAX * sizeof(unsigned int))
+#define UART_IR_LAST_LEN    (2 + IRT_DATA_MAX)
+#define UART_DATA_LEN       (UART_CAPTURE_LEN > UART_IR_LAST_LEN ? UART_CAPTURE_LEN : UART_IR_LAST_LEN)   // 応答の最大長
+#define UART_FRAME_LEN(N)   ((N) + 4)   // SOF, CMD, LEN, DATA[N], CRC
+#define UART_FRAME_MAX      UART_FRAME_LEN(UART_DATA_LEN)
+#define UART_BRG(F)         ((unsigned int)((F) / (4.0 * UART_BAUD) - 0.5))   // BRGH=1, BRG16=1
+
+typedef enum {
+    UART_RX_SOF = 0,
+    UART_RX_CMD,
+    UART_RX_LEN,
+    UART_RX_DATA,
+    UART_RX_CRC,
+} uart_rx_state_t;
+
+typedef struct {
+    unsigned char   head;
+    unsigned char   tail;
+    unsigned char   buf[UART_RING_LEN];
+} uart_ring_t;
+
+typedef struct {
+    uart_rx_state_t rx_state;
+    unsigned char   rx_cmd;
+    unsigned char   rx_len;
+    unsigned char   rx_pos;
+    unsigned char   rx_crc;
+    unsigned char   rx_data[UART_PAYLOAD_MAX];
+    uart_ring_t     tx;
+    volatile char   write_pending;  // メインループで処理する設定の書き込み(1=書き込み待ち, 2=応答待ち)
+    unsigned char   write_offset;
+    unsigned char   write_value;
+    volatile char   boot_pending;   // 応答の送信後にブートローダーを起動する
+} uart_data_t;
+
+uart_data_t uart_data;
+#define UART    uart_data
+
+static unsigned char uart_crc8(unsigned char crc, unsigned char data)
+{
+    unsigned char i;
+
+    crc ^= data;
+    for( i = 0; i < 8; i++ )
+    {
+        crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+    return crc;
+}
+
+// 送信バッファの空き(割り込み禁止の状態で呼ぶこと)
+static unsigned char uart_tx_free(void)
+{
+    return (UART.tx.tail - UART.tx.head - 1) & (UART_RING_LEN - 1);
+}
+
+static void uart_put(unsigned char data)
+{
+    unsigned char next = (UART.tx.head + 1) & (UART_RING_LEN - 1);
+
+    if( next == UART.tx.tail )
+        return;     // バッファフル。送信前にuart_tx_freeで空きを確認するので起こらない
+    UART.tx.buf[UART.tx.head] = data;
+    UART.tx.head = next;
+}
+
+// 割り込み禁止の状態で呼ぶこと
+static void uart_send(unsigned char cmd, const unsigned char *data, unsigned char len)
+{
+    unsigned char crc = 0;
+
+    uart_put(UART_SOF);
+    uart_put(cmd);
+    crc = uart_crc8(crc, cmd);
+    uart_put(len);
+    crc = uart_crc8(crc, len);
+    for( ; len > 0; len--, data++ )
+    {
+        uart_put(*data);
+        crc = uart_crc8(crc, *data);
+    }
+    uart_put(crc);
+    PIE3bits.TX1IE = 1;
+}
+
+static void uart_send_result(unsigned char cmd, uart_result_t result)
+{
+    unsigned char data[2];
+
+    data[0] = cmd;
+    data[1] = result;
+    uart_send(UART_CMD_ERROR, data, 2);
+}
+
+// 受信したフレームの処理(割り込み処理内)
+static void uart_dispatch(void)
+{
+    unsigned char data[UART_DATA_LEN];
+    unsigned char cmd = UART.rx_cmd;
+    unsigned char length;
+    unsigned char flags;
+    irr_type_t type;
+
+    switch( cmd )
+    {
+        case UART_CMD_STATUS:
+            if( UART.rx_len != 0 )
+                break;
+            data[0] = (PC_POWER_LED_N == 0);
+            data[1] = COMMON.received;
+            data[2] = COMMON.keycode;
+            data[3] = COMMON.command;
+            uart_send(cmd | UART_RESPONSE, data, 4);
+            return;
+
+        case UART_CMD_POWER:
+            if( UART.rx_len != 1 || UART.rx_data[0] == CMD_NONE || UART.rx_data[0] > CMD_LONGPUSH )
+                break;
+            if( COMMON.received != 0 )
+            {
+                data[0] = UART_RESULT_BUSY;
+            }
+            else
+            {
+                // 電源LEDの確認はIRと同じくメインループで行う
+                COMMON.keycode = KEYCODE_NONE;
+                COMMON.command = UART.rx_data[0];
+                COMMON.received = 1;
+                data[0] = UART_RESULT_OK;
+            }
+            uart_send(cmd | UART_RESPONSE, data, 1);
+            return;
+
+        case UART_CMD_STATS:
+            if( UART.rx_len != 0 )
+                break;
+            uart_send(cmd | UART_RESPONSE, (const unsigned char *)&irr_stats, sizeof(irr_stats));
+            return;
+
+        case UART_CMD_SETTING_READ:
+            if( UART.rx_len != 1 || UART.rx_data[0] >= sizeof(SETTINGS) )
+                break;
+            data[0] = UART.rx_data[0];
+            data[1] = ((const unsigned char *)&SETTINGS)[data[0]];
+            uart_send(cmd | UART_RESPONSE, data, 2);
+            return;
+
+        case UART_CMD_SETTING_WRITE:
+            if( UART.rx_len != 2 || UART.rx_data[0] >= sizeof(SETTINGS) )
+                break;
+            if( UART.write_pending != 0 )
+            {
+                uart_send_result(cmd, UART_RESULT_BUSY);
+                return;
+            }
+            // フラッシュの書き込み中はCPUが止まるのでメインループで行う
+            UART.write_offset = UART.rx_data[0];
+            UART.write_value = UART.rx_data[1];
+            UART.write_pending = 1;
+            return;
+
+        case UART_CMD_CLOCK:
+            if( UART.rx_len != 0 )
+                break;
+            uart_send(cmd | UART_RESPONSE, (const unsigned char *)&clock_stats, sizeof(clock_stats));
+            return;
+
+        case UART_CMD_IR_SEND:
+            if( UART.rx_len < 2 )
+                break;
+            if( ir_transmitter_send(UART.rx_data[0], (const char *)&UART.rx_data[1], UART.rx_len - 1) == 0 )
+            {
+                // 送信中か、送信できない種類
+                data[0] = ir_transmitter_busy() ? UART_RESULT_BUSY : UART_RESULT_INVALID;
+            }
+            else
+            {
+                data[0] = UART_RESULT_OK;
+            }
+            uart_send(cmd | UART_RESPONSE, data, 1);
+            return;
+
+#ifdef IRR_CAPTURE_ENABLE
+        case UART_CMD_CAPTURE:
+            if( UART.rx_len != 1 )
+                break;
+            length = ir_receiver_get_capture((irr_capture_info_t *)data, UART.rx_data[0],
+                                             (unsigned int *)&data[sizeof(irr_capture_info_t) + 1], UART_CAPTURE_READ_MAX);
+            data[sizeof(irr_capture_info_t)] = UART.rx_data[0];
+            uart_send(cmd | UART_RESPONSE, data, sizeof(irr_capture_info_t) + 1 + length * sizeof(unsigned int));
+            return;
+
+        case UART_CMD_CAPTURE_MODE:
+            if( UART.rx_len != 1 || UART.rx_data[0] >= IRR_MODE_MAX )
+                break;
+            ir_receiver_set_mode(UART.rx_data[0]);
+            data[0] = UART_RESULT_OK;
+            uart_send(cmd | UART_RESPONSE, data, 1);
+            return;
+#endif
+
+        case UART_CMD_IR_LAST:
+            if( UART.rx_len != 0 )
+                break;
+            // IR_SENDで送れる長さまで返す。切り詰めた場合や複数のフレームはフラグで知らせる
+            length = ir_receiver_get_last(&type, &flags, (char *)&data[2], IRT_DATA_MAX);
+            data[0] = type;
+            data[1] = flags;
+            uart_send(cmd | UART_RESPONSE, data, 2 + length);
+            return;
+
+        case UART_CMD_BOOT:
+            if( UART.rx_len != 0 )
+                break;
+            UART.boot_pending = 1;
+            data[0] = UART_RESULT_OK;
+            uart_send(cmd | UART_RESPONSE, data, 1);
+            return;
+
+#ifdef POWER_STATS_ENABLE
+        case UART_CMD_POWER_STATS:
+            if( UART.rx_len != 1 || UART.rx_data[0] == CMD_NONE || UART.rx_data[0] > CMD_LONGPUSH )
+                break;
+            data[0] = UART.rx_data[0];
+            c_memcopy(&data[1], power_stats_get(data[0]), POWER_STATS_BUCKETS);
+            uart_send(cmd | UART_RESPONSE, data, 1 + POWER_STATS_BUCKETS);
+            return;
+#endif
+
+        default:
+            break;
+    }
+    uart_send_result(cmd, UART_RESULT_INVALID);
+}
+
+void __interrupt(__flags(PEIE, RC1IE, RC1IF, 14))
+    uart_rx_isr(void)
+{
+    unsigned char data;
+
+    if( RC1STAbits.OERR )
+    {
+        // オーバーランの解除
+        RC1STAbits.CREN = 0;
+        RC1STAbits.CREN = 1;
+        UART.rx_state = UART_RX_SOF;
+    }
+    data = RC1REG;  // RC1IFは読み出しでクリアされる
+
+    switch( UART.rx_state )
+    {
+        case UART_RX_SOF:
+            if( data == UART_SOF )
+                UART.rx_state = UART_RX_CMD;
+            break;
+
+        case UART_RX_CMD:
+            UART.rx_cmd = data;
+            UART.rx_crc = uart_crc8(0, data);
+            UART.rx_state = UART_RX_LEN;
+            break;
+
+        case UART_RX_LEN:
+            UART.rx_len = data;
+            UART.rx_pos = 0;
+            UART.rx_crc = uart_crc8(UART.rx_crc, data);
+            UART.rx_state = (data == 0) ? UART_RX_CRC : UART_RX_DATA;
+            break;
+
+        case UART_RX_DATA:
+            // UART_PAYLOAD_MAXを超える分は読み捨て、CRCの確認後にUART_RESULT_INVALIDで応答する
+            if( UART.rx_pos < UART_PAYLOAD_MAX )
+                UART.rx_data[UART.rx_pos] = data;
+            UART.rx_pos++;
+            UART.rx_crc = uart_crc8(UART.rx_crc, data);
+            if( UART.rx_pos >= UART.rx_len )
+                UART.rx_state = UART_RX_CRC;
+            break;
+
+        case UART_RX_CRC:
+            // CRCが一致しないフレームは応答しない(ホスト側で再送する)
+            // 要求を続けて送られた場合、応答がフレームの途中で切れないよう
+            // 最大の応答が入る空きがなければ処理せずにBUSYで応答する
+            if( data == UART.rx_crc )
+            {
+                if( UART.rx_len <= UART_PAYLOAD_MAX && uart_tx_free() >= UART_FRAME_MAX )
+                    uart_dispatch();
+                else if( uart_tx_free() >= UART_FRAME_LEN(2) )
+                    uart_send_result(UART.rx_cmd, UART.rx_len > UART_PAYLOAD_MAX ? UART_RESULT_INVALID : UART_RESULT_BUSY);
+            }
+            UART.rx_state = UART_RX_SOF;
+            break;
+
+        default:
+            UART.rx_state = UART_RX_SOF;
+            break;
+    }
+}
+
+void __interrupt(__flags(PEIE, TX1IE, TX1IF, 15))
+    uart_tx_isr(void)
+{
+    if( UART.tx.tail != UART.tx.head )
+    {
+        TX1REG = UART.tx.buf[UART.tx.tail];
+        UART.tx.tail = (UART.tx.tail + 1) & (UART_RING_LEN - 1);
+    }
+    else
+    {
+        PIE3bits.TX1IE = 0;
+    }
+}
+
+// メインループから呼ぶ
+void uart_poll(void)
+{
+    unsigned char data[2];
+
+    // ブートローダー(bootloader/)はRESET命令による起動を要求とみなす
+    if( UART.boot_pending != 0 && PIE3bits.TX1IE == 0 && TX1STAbits.TRMT != 0 )
+    {
+        di();
+        RESET();
+    }
+
+    if( UART.write_pending == 0 )
+        return;
+
+    if( UART.write_pending == 1 )
+    {
+        settings_write(UART.write_offset, UART.write_value);
+        if(    UART.write_offset == SETTINGS_OFFSET(leader_coeff_min)
+            || UART.write_offset == SETTINGS_OFFSET(leader_coeff_max) )
+            ir_receiver_update_windows();
+        UART.write_pending = 2;
+    }
+    // 送信バッファに空きがなければ次の呼び出しで応答する
+    data[0] = UART.write_offset;
+    data[1] = ((const unsigned char *)&SETTINGS)[data[0]];
+    di();
+    if( uart_tx_free() >= UART_FRAME_LEN(2) )
+    {
+        uart_send(UART_CMD_SETTING_WRITE | UART_RESPONSE, data, 2);
+        UART.write_pending = 0;
+    }
+    ei();
+}
+
+// メインループで処理する要求があるか
+char uart_pending(void)
+{
+    return UART.write_pending | UART.boot_pending;
+}
+
+// システムクロックの切り替えの前に呼ぶ(割り込み禁止の状態で)
+// 送受信中の1文字はボーレートがずれて壊れるので、終わるまで待つ。RXがLのまま(未接続など)でも
+// 止まらないよう、UART_IDLE_WAIT_USで打ち切る(__delay_usは32MHz前提なので、8MHzでは4倍になる)
+void uart_wait_idle(void)
+{
+    unsigned char n;
+
+    for( n = UART_IDLE_WAIT_US / 10; n > 0; n-- )
+    {
+        if( TX1STAbits.TRMT != 0 && BAUD1CONbits.RCIDL != 0 )
+            return;
+        __delay_us(10);
+    }
+}
+
+// システムクロックの切り替え時にボーレートを合わせる(割り込み禁止の状態で呼ぶ)
+void uart_clock_changed(char fast)
+{
+    if( fast != 0 )
+    {
+        SP1BRGL = UART_BRG(_XTAL_FREQ) & 0xFF;
+        SP1BRGH = UART_BRG(_XTAL_FREQ) >> 8;
+    }
+    else
+    {
+        SP1BRGL = UART_BRG(CLOCK_IDLE_FREQ) & 0xFF;
+        SP1BRGH = UART_BRG(CLOCK_IDLE_FREQ) >> 8;
+    }
+}
+
+void uart_init(void)
+{
+    c_memzero(&UART, sizeof(UART));
+
+    BAUD1CON = 0x08;    // ABDOVF=0, RCIDL=0, (0), SCKP=0, BRG16=1, (0), WUE=0, ABDEN=0
+    SP1BRGL = UART_BRG(_XTAL_FREQ) & 0xFF;
+    SP1BRGH = UART_BRG(_XTAL_FREQ) >> 8;
+    TX1STA = 0x24;      // CSRC=0, TX9=0, TXEN=1, SYNC=0, SENDB=0, BRGH=1, (TRMT), TX9D=0
+    RC1STA = 0x90;      // SPEN=1, RX9=0, SREN=0, CREN=1, ADDEN=0, (FERR), (OERR), RX9D=0
+
+    PIR3bits.RC1IF = 0;
+    PIE3bits.RC1IE = 1;
+    PIE3bits.TX1IE = 0;
+}
+
+#else
+
+void uart_wait_idle(void)
+{
+}
+
+void uart_clock_changed(char fast)
+{
+}
+
+void uart_init(void)
+{
+}
+
+void uart_poll(void)
+{
+}
+
+char uart_pending(void)
+{
+    return 0;
+}
+
+#endif  // UART_ENABLE
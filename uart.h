@@ -0,0 +1,67 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 dragonkomat
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _IR_REMOCON_ANALYZER_UART_H_
+#define _IR_REMOCON_ANALYZER_UART_H_
+
+#define UART_ENABLE                 // ホストPCとのUART通信(RA4: TX, RC2: RX)
+
+#define UART_BAUD           115200
+#define UART_RING_LEN       32      // 送受信バッファのサイズ(2のべき乗で指定)
+#define UART_PAYLOAD_MAX    17      // 受信するペイロードの最大長(IR送信: 種類 + 16バイト)
+#define UART_CAPTURE_READ_MAX   6   // CAPTUREの応答1回で返す幅の数
+#define UART_IDLE_WAIT_US   100     // クロックの切り替え前に送受信中の1文字(約87us)を待つ最大時間
+
+// フレーム: SOF(0xA5), CMD, LEN, DATA[LEN], CRC8(CMD〜DATA, 多項式0x07, 初期値0x00)
+// 応答のCMDは要求のCMD | 0x80。不正な要求にはUART_CMD_ERRORで応答する
+#define UART_SOF            0xA5
+#define UART_RESPONSE       0x80
+
+#define UART_CMD_STATUS     0x01    // 応答: 電源(1=ON), 処理中, 最後のキーコード, 処理中の要求
+#define UART_CMD_POWER      0x02    // 要求: pcremocon_cmd_t, 応答: uart_result_t
+#define UART_CMD_STATS      0x03    // 応答: irr_stats_t
+#define UART_CMD_SETTING_READ   0x04    // 要求: オフセット, 応答: オフセット, 値
+#define UART_CMD_SETTING_WRITE  0x05    // 要求: オフセット, 値, 応答: オフセット, 値(書き込み後に応答)
+#define UART_CMD_IR_SEND    0x06    // 要求: irr_type_t, データ, 応答: uart_result_t
+#define UART_CMD_IR_LAST    0x07    // 応答: 最後に受信したirr_type_t, フラグ(IRR_LAST_*), データ(最大16バイト)
+#define UART_CMD_CLOCK      0x08    // 応答: clock_stats_t
+#define UART_CMD_CAPTURE    0x09    // 要求: 開始位置, 応答: irr_capture_info_t, 開始位置, 幅(最大UART_CAPTURE_READ_MAX個)
+#define UART_CMD_CAPTURE_MODE   0x0A    // 要求: irr_mode_t, 応答: uart_result_t(次のフレームから反映)
+#define UART_CMD_POWER_STATS    0x0B    // 要求: pcremocon_cmd_t, 応答: pcremocon_cmd_t, 各バケットの回数(POWER_STATS_BUCKETS個)
+#define UART_CMD_BOOT       0x0C    // 応答: uart_result_t(応答の送信後にRESET命令でブートローダーを起動)
+#define UART_CMD_ERROR      0x7F    // 応答: 要求のCMD, uart_result_t
+
+typedef enum {
+    UART_RESULT_OK = 0,
+    UART_RESULT_BUSY,
+    UART_RESULT_INVALID,
+} uart_result_t;
+
+void uart_wait_idle(void);
+void uart_clock_changed(char fast);
+void uart_init(void);
+void uart_poll(void);
+char uart_pending(void);
+
+#endif // _IR_REMOCON_ANALYZER_UART_H_